@@ -31,6 +31,53 @@ TRACE_EVENT(tracing_mark_write,
 		__entry->type, __entry->pid, __get_str(name), __entry->value)
 );
 
+TRACE_EVENT(dpu_hibernation_exit_phase,
+	TP_PROTO(int id, const char *phase, s64 latency_us),
+	TP_ARGS(id, phase, latency_us),
+	TP_STRUCT__entry(
+		__field(int, id)
+		__string(phase, phase)
+		__field(s64, latency_us)
+	),
+	TP_fast_assign(
+		__entry->id = id;
+		__assign_str(phase, phase);
+		__entry->latency_us = latency_us;
+	),
+	TP_printk("decon%d %s %lldus",
+		__entry->id, __get_str(phase), __entry->latency_us)
+);
+
+DECLARE_EVENT_CLASS(dpu_gem_iommu,
+	TP_PROTO(size_t size, dma_addr_t dma_addr),
+	TP_ARGS(size, dma_addr),
+	TP_STRUCT__entry(
+		__field(size_t, size)
+		__field(u64, dma_addr)
+	),
+	TP_fast_assign(
+		__entry->size = size;
+		__entry->dma_addr = dma_addr;
+	),
+	TP_printk("dma_addr=0x%llx size=%zu",
+		__entry->dma_addr, __entry->size)
+);
+
+DEFINE_EVENT(dpu_gem_iommu, dpu_gem_iommu_map,
+	TP_PROTO(size_t size, dma_addr_t dma_addr),
+	TP_ARGS(size, dma_addr)
+);
+
+DEFINE_EVENT(dpu_gem_iommu, dpu_gem_iommu_unmap,
+	TP_PROTO(size_t size, dma_addr_t dma_addr),
+	TP_ARGS(size, dma_addr)
+);
+
+DEFINE_EVENT(dpu_gem_iommu, dpu_gem_iommu_reuse,
+	TP_PROTO(size_t size, dma_addr_t dma_addr),
+	TP_ARGS(size, dma_addr)
+);
+
 #define DPU_ATRACE_INT_PID(name, value, pid) trace_tracing_mark_write('C', pid, name, value)
 #define DPU_ATRACE_INT(name, value) DPU_ATRACE_INT_PID(name, value, current->tgid)
 #define DPU_ATRACE_BEGIN(name) trace_tracing_mark_write('B', current->tgid, name, 0)
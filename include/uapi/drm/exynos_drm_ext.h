@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: GPL-2.0 WITH Linux-syscall-note */
+/*
+ * Exynos DRM uapi extensions on top of <drm/samsung_drm.h>
+ *
+ * Copyright (C) 2026 Google, Inc.
+ */
+#ifndef _UAPI_EXYNOS_DRM_EXT_H_
+#define _UAPI_EXYNOS_DRM_EXT_H_
+
+#include <drm/drm.h>
+
+/*
+ * Driver private ioctl numbers and event types of this header must not be
+ * reused by <drm/samsung_drm.h>, exynos_drm_drv.c checks this at build time.
+ */
+#define DRM_EXYNOS_WB_STREAM_START	0x20
+#define DRM_EXYNOS_WB_STREAM_STOP	0x21
+#define DRM_EXYNOS_FB_HANDOVER		0x22
+#define DRM_EXYNOS_WB_STREAM_RELEASE	0x23
+
+#define EXYNOS_DRM_WB_STREAM_EVENT	0x80000010
+
+/*
+ * Streaming CWB interface. Userspace registers a ring of output buffers once
+ * and gets an event with the buffer index for every captured frame, instead
+ * of committing a writeback job per frame. The buffer of an event belongs to
+ * userspace until it's given back with WB_STREAM_RELEASE, capture skips such
+ * buffers and frames are dropped while none of the buffers is released.
+ */
+#define EXYNOS_DRM_WB_STREAM_MAX_BUFS	8
+
+struct exynos_drm_wb_stream_start {
+	__u32 connector_id;
+	__u32 num_bufs;
+	/* capture one out of every decimation frames, 0 is same as 1 */
+	__u32 decimation;
+	__u32 fb_ids[EXYNOS_DRM_WB_STREAM_MAX_BUFS];
+};
+
+struct exynos_drm_wb_stream_event {
+	struct drm_event base;
+	__u64 timestamp_ns;
+	__u32 connector_id;
+	/* incremented for every captured frame, gaps mean dropped events */
+	__u32 sequence;
+	/* index of the buffer which has been written */
+	__u32 index;
+	__u32 reserved;
+};
+
+struct exynos_drm_wb_stream_release {
+	__u32 connector_id;
+	/* index of a buffer received by stream event */
+	__u32 index;
+};
+
+#define DRM_IOCTL_EXYNOS_WB_STREAM_START	DRM_IOW(DRM_COMMAND_BASE + \
+		DRM_EXYNOS_WB_STREAM_START, struct exynos_drm_wb_stream_start)
+#define DRM_IOCTL_EXYNOS_WB_STREAM_STOP		DRM_IOW(DRM_COMMAND_BASE + \
+		DRM_EXYNOS_WB_STREAM_STOP, __u32)
+#define DRM_IOCTL_EXYNOS_WB_STREAM_RELEASE	DRM_IOW(DRM_COMMAND_BASE + \
+		DRM_EXYNOS_WB_STREAM_RELEASE, struct exynos_drm_wb_stream_release)
+
+/* wraps bootloader framebuffer of @crtc_id into a GEM handle */
+struct exynos_drm_fb_handover {
+	__u32 crtc_id;
+	__u32 handle;
+	__u64 size;
+};
+
+#define DRM_IOCTL_EXYNOS_FB_HANDOVER	DRM_IOWR(DRM_COMMAND_BASE + \
+		DRM_EXYNOS_FB_HANDOVER, struct exynos_drm_fb_handover)
+
+#endif /* _UAPI_EXYNOS_DRM_EXT_H_ */
@@ -1533,6 +1533,45 @@ static int dsim_reg_get_dphy_timing(u32 id, u32 hs_clk, u32 esc_clk,
 	return 0;
 }
 
+/* escape clock divider for the requested escape clock, rounded to not exceed it */
+static u32 dsim_reg_calc_esc_div(u32 word_clk, u32 esc_clk)
+{
+	u32 esc_div;
+
+	esc_div = word_clk / esc_clk;
+	if (esc_div && (word_clk / esc_div) > esc_clk)
+		esc_div += 1;
+
+	return esc_div;
+}
+
+bool dsim_reg_is_dphy_timing_shared(u32 id, u32 hs_clk0, u32 hs_clk1, u32 esc_clk)
+{
+	struct dphy_timing_value t0, t1;
+	u32 esc_div0, esc_div1;
+
+	/* hsmode and skewcal are selected around 1500Mbps */
+	if ((hs_clk0 < 1500) != (hs_clk1 < 1500))
+		return false;
+
+	if (!esc_clk)
+		return false;
+
+	esc_div0 = dsim_reg_calc_esc_div(hs_clk0 / 16, esc_clk);
+	esc_div1 = dsim_reg_calc_esc_div(hs_clk1 / 16, esc_clk);
+	if (!esc_div0 || esc_div0 != esc_div1)
+		return false;
+
+	if (dsim_reg_get_dphy_timing(id, hs_clk0, hs_clk0 / 16 / esc_div0, &t0) ||
+	    dsim_reg_get_dphy_timing(id, hs_clk1, hs_clk1 / 16 / esc_div1, &t1))
+		return false;
+
+	/* bps only records the requested clock */
+	t1.bps = t0.bps;
+
+	return !memcmp(&t0, &t1, sizeof(t0));
+}
+
 static void dsim_reg_set_config(u32 id, struct dsim_reg_config *config,
 						struct dsim_clks *clks)
 {
@@ -1743,11 +1782,7 @@ static int dsim_reg_set_clocks(u32 id, const struct dsim_reg_config *config,
 				clks->esc_clk);
 
 		/* escape clock divider */
-		esc_div = clks->word_clk / clks->esc_clk;
-
-		/* adjust escape clock */
-		if ((clks->word_clk / esc_div) > clks->esc_clk)
-			esc_div += 1;
+		esc_div = dsim_reg_calc_esc_div(clks->word_clk, clks->esc_clk);
 
 		/* adjusted escape clock */
 		clks->esc_clk = clks->word_clk / esc_div;
@@ -240,6 +240,11 @@ void dsim_reg_set_cmd_transfer_mode(u32 id, u32 lp);
 
 /* Frequency Hopping feature for EVT1 */
 void dsim_reg_set_dphy_freq_hopping(u32 id, u32 p, u32 m, u32 k, u32 en);
+/*
+ * Whether both hs clocks (Mbps) use the same D-PHY timing values, escape clock
+ * divider and hsmode/skewcal setting, that is, only PLL M/K differ.
+ */
+bool dsim_reg_is_dphy_timing_shared(u32 id, u32 hs_clk0, u32 hs_clk1, u32 esc_clk);
 
 /* DSIM SFR dump */
 void __dsim_dump(struct drm_printer *p, u32 id, struct dsim_regs *regs);
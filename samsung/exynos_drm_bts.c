@@ -34,6 +34,7 @@
 #endif
 
 #include <linux/kernel.h>
+#include <linux/slab.h>
 #include <trace/dpu_trace.h>
 #include "exynos_drm_decon.h"
 #include "exynos_drm_format.h"
@@ -231,29 +232,17 @@ static u32 dpu_bts_find_nearest_high_freq(struct decon_device *decon, u32 aclk_b
 	return i;
 }
 
-/*
- * [caution] src_w/h is rotated size info
- * - src_w : src_h @original input image
- * - src_h : src_w @original input image
- */
-static u64 dpu_bts_calc_rotate_aclk(struct decon_device *decon, u32 aclk_base,
-		u32 ppc, u32 src_w, u32 dst_w,
-		bool is_comp, bool is_downscale, bool is_dsc)
+struct dpu_bts_rot_cycle {
+	u32 basic_cycle;
+	u32 module_cycle;
+};
+
+static void dpu_bts_calc_rotate_cycle(struct decon_device *decon, u32 ppc,
+		u32 src_w, u32 dst_w, bool is_comp, bool is_downscale, bool is_dsc,
+		struct dpu_bts_rot_cycle *cycle)
 {
-	u32 dfs_idx = 0;
-	u32 dpu_cycle, basic_cycle, dsi_cycle, module_cycle = 0;
+	u32 dsi_cycle, module_cycle = 0;
 	u32 comp_cycle = 0, rot_cycle = 0, scale_cycle = 0, dsc_cycle = 0;
-	u32 rot_init_bw = 0; /* KB/s */
-	u64 rot_clk, rot_need_clk;
-	u32 aclk_x_1k_ns, dpu_lat_t_ns, max_lat_t_ns, tx_allow_t_ns;
-	u32 bus_perf;
-	u32 temp_clk;
-	bool retry_flag = false;
-
-	DPU_DEBUG_BTS("[ROT+] BEFORE latency check: %u KHz\n", aclk_base);
-
-	dfs_idx = dpu_bts_find_nearest_high_freq(decon, aclk_base);
-	rot_clk = decon->bts.dfs_lv_khz[dfs_idx];
 
 	/* post DECON OUTFIFO based on 1H transfer */
 	dsi_cycle = decon->config.image_width;
@@ -262,24 +251,20 @@ static u64 dpu_bts_calc_rotate_aclk(struct decon_device *decon, u32 aclk_base,
 	if (is_comp) {
 		comp_cycle = dpu_bts_comp_latency(src_w, ppc,
 			decon->bts.delay_comp);
-		DPU_DEBUG_BTS("  COMP: lat_cycle(%u)\n", comp_cycle);
 		module_cycle += comp_cycle;
 	} else {
 		rot_cycle = dpu_bts_rotate_latency(src_w,
 			decon->bts.ppc_rotator);
-		DPU_DEBUG_BTS("  ROT: lat_cycle(%u)\n", rot_cycle);
 		module_cycle += rot_cycle;
 	}
 	if (is_downscale) {
 		scale_cycle = dpu_bts_scale_latency(src_w, dst_w,
 			decon->bts.ppc_scaler, decon->bts.delay_scaler);
-		DPU_DEBUG_BTS("  SCALE: lat_cycle(%u)\n", scale_cycle);
 		module_cycle += scale_cycle;
 	}
 	if (is_dsc) {
 		dsc_cycle = dpu_bts_dsc_latency(decon->config.dsc.slice_count,
 			decon->config.dsc.dsc_count, dst_w, ppc);
-		DPU_DEBUG_BTS("  DSC: lat_cycle(%u)\n", dsc_cycle);
 		module_cycle += dsc_cycle;
 		dsi_cycle = (dsi_cycle + 2) / 3;
 	}
@@ -292,26 +277,179 @@ static u64 dpu_bts_calc_rotate_aclk(struct decon_device *decon, u32 aclk_base,
 	 * Here, (aclk_mhz * 2) cycles are reflected referring to the result
 	 *  because the exact value is unknown.
 	 */
-	basic_cycle = (decon->config.image_width * 11 / 10 + dsi_cycle) / ppc;
+	cycle->basic_cycle = (decon->config.image_width * 11 / 10 + dsi_cycle) / ppc;
+	cycle->module_cycle = module_cycle;
+}
 
-retry_hi_freq:
-	dpu_cycle = (basic_cycle + module_cycle) + rot_clk * 2 / 1000U;
+/* return : kHz value of ACLK needed for rotation initial latency at rot_clk */
+static u64 dpu_bts_calc_rotate_need_clk(struct decon_device *decon, u64 rot_clk,
+		u32 src_w, const struct dpu_bts_rot_cycle *cycle, u32 max_lat_t_ns)
+{
+	u32 dpu_cycle;
+	u32 rot_init_bw; /* KB/s */
+	u32 aclk_x_1k_ns, dpu_lat_t_ns, tx_allow_t_ns;
+	u32 bus_perf;
+
+	dpu_cycle = (cycle->basic_cycle + cycle->module_cycle) + rot_clk * 2 / 1000U;
 	aclk_x_1k_ns = dpu_bts_convert_aclk_to_ns(rot_clk / 1000U);
 	dpu_lat_t_ns = mult_frac(aclk_x_1k_ns, dpu_cycle, 1000);
-	max_lat_t_ns = dpu_bts_get_vblank_time_ns(decon);
 	if (max_lat_t_ns > dpu_lat_t_ns) {
 		tx_allow_t_ns = max_lat_t_ns - dpu_lat_t_ns;
 	} else {
 		/* abnormal case : apply bus_util_pct of v_blank */
 		tx_allow_t_ns = (max_lat_t_ns * decon->bts.bus_util_pct) / 100;
-		DPU_DEBUG_BTS("  WARN: latency calc is abnormal!(-> %u%%)\n",
-				decon->bts.bus_util_pct);
 	}
 
 	bus_perf = decon->bts.bus_width * decon->bts.rot_util_pct;
 	/* apply as worst(P010: 3) case to simplify */
 	rot_init_bw = mult_frac(NSEC_PER_SEC, src_w * ROT_READ_BYTE * 3, tx_allow_t_ns) / 1000;
-	rot_need_clk = rot_init_bw * 100 / bus_perf;
+
+	return rot_init_bw * 100 / bus_perf;
+}
+
+/*
+ * Rotation ACLK lookup table
+ *
+ * For rotated layers without downscaling, the clock needed to meet the initial
+ * rotation latency only depends on the (rotated) source width, compression and
+ * the display mode. It is precomputed per source width bucket and DFS level, so
+ * that atomic commits only have to pick the entry instead of running latency
+ * math for every rotated layer. The table is rebuilt whenever any of the mode
+ * dependent parameters it was built with change.
+ */
+#define ROT_LUT_WIDTH_STEP	32
+#define ROT_LUT_COMP_CNT	2
+
+static inline u32 *dpu_bts_rot_lut_entry(const struct dpu_bts_rot_lut *lut,
+		u32 bucket, bool is_comp)
+{
+	return &lut->need_khz[(bucket * ROT_LUT_COMP_CNT + is_comp) * lut->dfs_lv_cnt];
+}
+
+static void dpu_bts_update_rot_lut(struct decon_device *decon, u32 ppc)
+{
+	struct dpu_bts_rot_lut *lut = &decon->bts.rot_lut;
+	const u32 image_width = decon->config.image_width;
+	const u32 vblank_t_ns = dpu_bts_get_vblank_time_ns(decon);
+	const bool is_dsc = decon->config.dsc.enabled;
+	struct dpu_bts_rot_cycle cycle;
+	u32 width_cnt, bucket, lv;
+	u32 *need_khz;
+	int comp;
+
+	if (lut->need_khz && lut->fps == decon->bts.fps &&
+			lut->vblank_t_ns == vblank_t_ns &&
+			lut->image_width == image_width && lut->ppc == ppc &&
+			lut->is_dsc == is_dsc &&
+			lut->dfs_lv_cnt == decon->bts.dfs_lv_cnt)
+		return;
+
+	kfree(lut->need_khz);
+	lut->need_khz = NULL;
+
+	if (!image_width || !vblank_t_ns || !decon->bts.dfs_lv_cnt)
+		return;
+
+	width_cnt = DIV_ROUND_UP(image_width, ROT_LUT_WIDTH_STEP);
+	need_khz = kcalloc(width_cnt * ROT_LUT_COMP_CNT * decon->bts.dfs_lv_cnt,
+			sizeof(*need_khz), GFP_KERNEL);
+	if (!need_khz) {
+		DPU_ERR_BTS("decon%u failed to allocate rotation lut\n", decon->id);
+		return;
+	}
+
+	lut->need_khz = need_khz;
+	lut->width_cnt = width_cnt;
+	lut->dfs_lv_cnt = decon->bts.dfs_lv_cnt;
+	lut->fps = decon->bts.fps;
+	lut->vblank_t_ns = vblank_t_ns;
+	lut->image_width = image_width;
+	lut->ppc = ppc;
+	lut->is_dsc = is_dsc;
+
+	for (bucket = 0; bucket < width_cnt; bucket++) {
+		/* use the upper bound of the bucket, latency grows with src_w */
+		const u32 src_w = (bucket + 1) * ROT_LUT_WIDTH_STEP;
+
+		for (comp = 0; comp < ROT_LUT_COMP_CNT; comp++) {
+			u32 *entry = dpu_bts_rot_lut_entry(lut, bucket, comp);
+
+			/* dsc latency is computed for full width destination */
+			dpu_bts_calc_rotate_cycle(decon, ppc, src_w, image_width,
+					comp, false, is_dsc, &cycle);
+
+			for (lv = 0; lv < lut->dfs_lv_cnt; lv++) {
+				u64 need = dpu_bts_calc_rotate_need_clk(decon,
+						decon->bts.dfs_lv_khz[lv], src_w,
+						&cycle, vblank_t_ns);
+
+				entry[lv] = min_t(u64, need, U32_MAX);
+			}
+		}
+	}
+
+	DPU_DEBUG_BTS("decon%u rotation lut: %u buckets @%ufps vblank %uns\n",
+			decon->id, width_cnt, lut->fps, vblank_t_ns);
+}
+
+static const u32 *dpu_bts_find_rot_lut(const struct decon_device *decon, u32 ppc,
+		u32 src_w, u32 dst_w, bool is_comp, bool is_downscale, bool is_dsc)
+{
+	const struct dpu_bts_rot_lut *lut = &decon->bts.rot_lut;
+	u32 bucket;
+
+	if (!lut->need_khz || lut->ppc != ppc || lut->is_dsc != is_dsc || !src_w)
+		return NULL;
+
+	/* scaler and dsc latency depend on dst_w, which is not part of the index */
+	if (is_downscale || (is_dsc && dst_w != lut->image_width))
+		return NULL;
+
+	bucket = DIV_ROUND_UP(src_w, ROT_LUT_WIDTH_STEP) - 1;
+	if (bucket >= lut->width_cnt)
+		return NULL;
+
+	return dpu_bts_rot_lut_entry(lut, bucket, is_comp);
+}
+
+/*
+ * [caution] src_w/h is rotated size info
+ * - src_w : src_h @original input image
+ * - src_h : src_w @original input image
+ */
+static u64 dpu_bts_calc_rotate_aclk(struct decon_device *decon, u32 aclk_base,
+		u32 ppc, u32 src_w, u32 dst_w,
+		bool is_comp, bool is_downscale, bool is_dsc)
+{
+	u32 dfs_idx = 0;
+	u64 rot_clk, rot_need_clk;
+	u32 max_lat_t_ns = 0;
+	u32 temp_clk;
+	const u32 *lut_need_khz;
+	struct dpu_bts_rot_cycle cycle = { 0 };
+	bool retry_flag = false;
+
+	DPU_DEBUG_BTS("[ROT+] BEFORE latency check: %u KHz\n", aclk_base);
+
+	dfs_idx = dpu_bts_find_nearest_high_freq(decon, aclk_base);
+	rot_clk = decon->bts.dfs_lv_khz[dfs_idx];
+
+	lut_need_khz = dpu_bts_find_rot_lut(decon, ppc, src_w, dst_w, is_comp,
+			is_downscale, is_dsc);
+	if (!lut_need_khz) {
+		dpu_bts_calc_rotate_cycle(decon, ppc, src_w, dst_w, is_comp,
+				is_downscale, is_dsc, &cycle);
+		DPU_DEBUG_BTS("  basic_cycle(%u) module_cycle(%u)\n",
+				cycle.basic_cycle, cycle.module_cycle);
+		max_lat_t_ns = dpu_bts_get_vblank_time_ns(decon);
+	}
+
+retry_hi_freq:
+	if (lut_need_khz)
+		rot_need_clk = lut_need_khz[dfs_idx];
+	else
+		rot_need_clk = dpu_bts_calc_rotate_need_clk(decon, rot_clk, src_w,
+				&cycle, max_lat_t_ns);
 
 	if (rot_need_clk > rot_clk) {
 		/* not max level */
@@ -320,8 +458,6 @@ retry_hi_freq:
 			dfs_idx--;
 			temp_clk = decon->bts.dfs_lv_khz[dfs_idx];
 			if ((rot_need_clk > temp_clk) && (!retry_flag)) {
-				DPU_DEBUG_BTS("  -allow_ns(%u) dpu_ns(%u)\n",
-					tx_allow_t_ns, dpu_lat_t_ns);
 				rot_clk = temp_clk;
 				retry_flag = true;
 				goto retry_hi_freq;
@@ -330,15 +466,22 @@ retry_hi_freq:
 		rot_clk = rot_need_clk;
 	}
 
-	DPU_DEBUG_BTS("  -dpu_cycle(%u) aclk_x_1k_ns(%u) dpu_lat_t_ns(%u)\n",
-			dpu_cycle, aclk_x_1k_ns, dpu_lat_t_ns);
-	DPU_DEBUG_BTS("  -tx_allow_t_ns(%u) rot_init_bw(%u) rot_need_clk(%llu)\n",
-			tx_allow_t_ns, rot_init_bw, rot_need_clk);
+	DPU_DEBUG_BTS("  -rot_need_clk(%llu) lut(%d)\n", rot_need_clk, !!lut_need_khz);
 	DPU_DEBUG_BTS("[ROT-] AFTER latency check: %llu KHz\n", rot_clk);
 
 	return rot_clk;
 }
 
+static u32 dpu_bts_get_ppc(const struct decon_device *decon)
+{
+	/* case for using dsc encoder 1ea at decon0 or decon1 */
+	if ((decon->id != 2) && (decon->config.dsc.dsc_count == 1))
+		return ((decon->bts.ppc / 2UL) >= 1UL) ?
+				(decon->bts.ppc / 2UL) : 1UL;
+
+	return decon->bts.ppc;
+}
+
 static u64 dpu_bts_calc_aclk_disp(struct decon_device *decon,
 				  const struct dpu_bts_win_config *config, u64 resol_clk,
 				  u32 max_clk)
@@ -362,12 +505,7 @@ static u64 dpu_bts_calc_aclk_disp(struct decon_device *decon,
 	if (src_w > config->dst_w || src_h > config->dst_h)
 		is_downscale = true;
 
-	/* case for using dsc encoder 1ea at decon0 or decon1 */
-	if ((decon->id != 2) && (decon->config.dsc.dsc_count == 1))
-		ppc = ((decon->bts.ppc / 2UL) >= 1UL) ?
-				(decon->bts.ppc / 2UL) : 1UL;
-	else
-		ppc = decon->bts.ppc;
+	ppc = dpu_bts_get_ppc(decon);
 
 	margin = 1100 + ((48000 + 20000) / decon->config.image_width);
 	diff_w = (src_w <= config->dst_w) ? 0 : src_w - config->dst_w;
@@ -811,6 +949,7 @@ static void dpu_bts_calc_bw(struct decon_device *decon)
 		rcd_idx = -1;
 	}
 
+	dpu_bts_update_rot_lut(decon, dpu_bts_get_ppc(decon));
 
 	for (i = 0; i < MAX_DPP_CNT; i++) {
 		if (i < MAX_WIN_PER_DECON)
@@ -1000,6 +1139,8 @@ static void dpu_bts_deinit(struct decon_device *decon)
 	exynos_pm_qos_remove_request(&decon->bts.disp_qos);
 	exynos_pm_qos_remove_request(&decon->bts.int_qos);
 	exynos_pm_qos_remove_request(&decon->bts.mif_qos);
+	kfree(decon->bts.rot_lut.need_khz);
+	decon->bts.rot_lut.need_khz = NULL;
 	DPU_DEBUG_BTS("%s -\n", __func__);
 }
 
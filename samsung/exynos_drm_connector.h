@@ -14,6 +14,7 @@
 #include <drm/drm_connector.h>
 #include <drm/samsung_drm.h>
 #include <drm/drm_dsc.h>
+#include <drm/drm_mipi_dsi.h>
 
 #define MIN_WIN_BLOCK_WIDTH	8
 #define MIN_WIN_BLOCK_HEIGHT	1
@@ -44,6 +45,73 @@ struct exynos_drm_connector;
 #define EXYNOS_DSI_MSG_FORCE_BATCH BIT(13)
 /* Mark the end of mipi commands transaction */
 #define EXYNOS_DSI_MSG_FORCE_FLUSH  BIT(12)
+/* msg is embedded in a struct exynos_dsi_packed_msg with pre-packed fifo words */
+#define EXYNOS_DSI_MSG_PACKED  BIT(11)
+
+/**
+ * struct exynos_dsi_packed_msg - dsi message with packet already built
+ * @msg: regular message, tx_buf/tx_len still describe the raw command bytes
+ * @header: packet header bytes as written to the ph fifo
+ * @payload: payload packed into little endian 32-bit pl fifo words
+ * @num_words: number of words in @payload, 0 for short packets
+ */
+struct exynos_dsi_packed_msg {
+	struct mipi_dsi_msg msg;
+	u8 header[3];
+	const u32 *payload;
+	u32 num_words;
+};
+
+/* msg is embedded in a struct exynos_dsi_async_msg, queue it instead of waiting for transfer */
+#define EXYNOS_DSI_MSG_ASYNC  BIT(10)
+
+/**
+ * struct exynos_dsi_async_msg - dsi write message submitted without blocking
+ * @msg: message to send, host copies it along with tx_buf before returning
+ * @complete: optional, called from host command worker with transfer result
+ * @data: private data passed to @complete
+ *
+ * Async messages are sent in submission order, and any synchronous transfer on the
+ * same host waits for previously queued messages first. Reads can't be queued.
+ */
+struct exynos_dsi_async_msg {
+	struct mipi_dsi_msg msg;
+	void (*complete)(void *data, int ret);
+	void *data;
+};
+
+/* msg is embedded in a struct exynos_dsi_read_batch, all reads are done in one transaction */
+#define EXYNOS_DSI_MSG_READ_BATCH  BIT(9)
+
+/**
+ * struct exynos_dsi_read - single dcs register read in a batch
+ * @reg: dcs register to read
+ * @rx_buf: buffer for the read back data
+ * @rx_len: number of bytes to read
+ * @ret: number of bytes read or negative error, filled by host
+ */
+struct exynos_dsi_read {
+	u8 reg;
+	void *rx_buf;
+	size_t rx_len;
+	ssize_t ret;
+};
+
+/**
+ * struct exynos_dsi_read_batch - dcs reads done back to back by the host
+ * @msg: dcs read message describing the batch, rx fields are unused
+ * @reads: reads to do in order
+ * @num_reads: number of entries in @reads
+ *
+ * Host keeps command lock and power across the whole batch, and only updates the maximum
+ * return packet size when it changes between reads. Transfer returns number of reads done,
+ * the batch stops at the first failing read.
+ */
+struct exynos_dsi_read_batch {
+	struct mipi_dsi_msg msg;
+	struct exynos_dsi_read *reads;
+	u32 num_reads;
+};
 
 struct exynos_drm_connector_properties {
 	struct drm_property *max_luminance;
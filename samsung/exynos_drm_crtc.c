@@ -359,6 +359,52 @@ static u32 exynos_drm_crtc_get_vblank_counter(struct drm_crtc *crtc)
 	return 0;
 }
 
+static const char * const exynos_crtc_crc_sources[] = { "auto", "dsimif" };
+
+static const char *const *
+exynos_drm_crtc_get_crc_sources(struct drm_crtc *crtc, size_t *count)
+{
+	*count = ARRAY_SIZE(exynos_crtc_crc_sources);
+
+	return exynos_crtc_crc_sources;
+}
+
+static int exynos_drm_crtc_verify_crc_source(struct drm_crtc *crtc,
+				const char *source, size_t *values_cnt)
+{
+	struct exynos_drm_crtc *exynos_crtc = to_exynos_crtc(crtc);
+
+	if (!exynos_crtc->ops->set_crc_source)
+		return -ENOTSUPP;
+
+	if (source && (!strcmp(source, "auto") || !strcmp(source, "dsimif"))) {
+		/* R, G and B */
+		*values_cnt = 3;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+static int exynos_drm_crtc_set_crc_source(struct drm_crtc *crtc,
+					  const char *source)
+{
+	struct exynos_drm_crtc *exynos_crtc = to_exynos_crtc(crtc);
+	size_t values_cnt;
+	bool enable = false;
+
+	if (!exynos_crtc->ops->set_crc_source)
+		return -ENOTSUPP;
+
+	if (source) {
+		if (exynos_drm_crtc_verify_crc_source(crtc, source, &values_cnt))
+			return -EINVAL;
+		enable = true;
+	}
+
+	return exynos_crtc->ops->set_crc_source(exynos_crtc, enable);
+}
+
 static void exynos_drm_crtc_destroy_state(struct drm_crtc *crtc,
 					struct drm_crtc_state *state)
 {
@@ -443,6 +489,8 @@ exynos_drm_crtc_duplicate_state(struct drm_crtc *crtc)
 	copy->skip_update = false;
 	copy->planes_updated = false;
 	copy->hibernation_exit = false;
+	copy->recovery_reset = false;
+	copy->recovery_dpp_mask = 0;
 
 	return &copy->base;
 }
@@ -551,7 +599,7 @@ static int exynos_drm_crtc_set_property(struct drm_crtc *crtc,
 	} else if (property == exynos_crtc->props.partial) {
 		ret = exynos_drm_replace_property_blob_from_id(state->crtc->dev,
 				&exynos_crtc_state->partial, val,
-				sizeof(struct drm_clip_rect), -1, &replaced);
+				-1, sizeof(struct drm_clip_rect), &replaced);
 		return ret;
 	} else if (property == exynos_crtc->props.cgc_lut_fd) {
 		if (exynos_crtc_state->cgc_gem)
@@ -638,7 +686,8 @@ static void exynos_drm_crtc_print_state(struct drm_printer *p,
 	const struct decon_device *decon = exynos_crtc->ctx;
 	const struct decon_config *cfg = &decon->config;
 	struct exynos_drm_crtc_state *exynos_state;
-	struct drm_clip_rect *partial_region;
+	const struct drm_clip_rect *partial_region;
+	size_t i, cnt;
 
 	exynos_state = container_of(state, struct exynos_drm_crtc_state, base);
 
@@ -658,12 +707,13 @@ static void exynos_drm_crtc_print_state(struct drm_printer *p,
 	drm_printf(p, "\t\tbpc=%d\n", cfg->out_bpc);
 
 	if (exynos_state->partial) {
-		partial_region =
-			(struct drm_clip_rect *)exynos_state->partial->data;
-		drm_printf(p, "\t\tpartial region[%d %d %d %d]\n",
-				partial_region->x1, partial_region->y1,
-				partial_region->x2 - partial_region->x1,
-				partial_region->y2 - partial_region->y1);
+		partial_region = exynos_state->partial->data;
+		cnt = exynos_state->partial->length / sizeof(*partial_region);
+		for (i = 0; i < cnt; i++)
+			drm_printf(p, "\t\tpartial region[%d %d %d %d]\n",
+					partial_region[i].x1, partial_region[i].y1,
+					partial_region[i].x2 - partial_region[i].x1,
+					partial_region[i].y2 - partial_region[i].y1);
 	} else {
 		drm_printf(p, "\t\tno partial region request\n");
 	}
@@ -691,6 +741,9 @@ static const struct drm_crtc_funcs exynos_crtc_funcs = {
 	.disable_vblank		= exynos_drm_crtc_disable_vblank,
 	.get_vblank_counter	= exynos_drm_crtc_get_vblank_counter,
 	.late_register		= exynos_drm_crtc_late_register,
+	.set_crc_source		= exynos_drm_crtc_set_crc_source,
+	.verify_crc_source	= exynos_drm_crtc_verify_crc_source,
+	.get_crc_sources	= exynos_drm_crtc_get_crc_sources,
 };
 
 static int
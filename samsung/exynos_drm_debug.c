@@ -1464,6 +1464,163 @@ static const struct file_operations hibernation_fops = {
 	.release = seq_release,
 };
 
+static int hibernation_pred_show(struct seq_file *s, void *unused)
+{
+	struct decon_device *decon = s->private;
+	struct exynos_hibernation_pred *pred = &decon->hibernation->pred;
+	u32 hist[HIBERNATION_PRED_BIN_CNT];
+	u32 delay_ms, decisions, samples, exit_cost_us, hits, misses, total;
+	unsigned long interval, flags;
+	unsigned int i;
+
+	/* copy counters only, lock stays with the live predictor */
+	spin_lock_irqsave(&pred->lock, flags);
+	memcpy(hist, pred->hist, sizeof(hist));
+	interval = ewma_hiber_interval_read(&pred->interval);
+	delay_ms = pred->delay_ms;
+	decisions = pred->decisions;
+	samples = pred->samples;
+	exit_cost_us = pred->exit_cost_us;
+	hits = pred->hits;
+	misses = pred->misses;
+	spin_unlock_irqrestore(&pred->lock, flags);
+
+	total = hits + misses;
+	seq_printf(s, "entry delay: %ums (decisions: %u)\n", delay_ms, decisions);
+	seq_printf(s, "interval avg: %luus samples: %u\n", interval, samples);
+	seq_printf(s, "exit cost: %uus\n", exit_cost_us);
+	seq_printf(s, "hit: %u miss: %u rate: %u%%\n", hits, misses,
+			total ? hits * 100 / total : 0);
+
+	seq_puts(s, "interval histogram:\n");
+	for (i = 0; i < HIBERNATION_PRED_BIN_CNT; i++) {
+		const u32 bound = exynos_hibernation_pred_bin_ms(i);
+
+		if (bound == U32_MAX)
+			seq_printf(s, "\t   >%4ums: %u\n",
+				exynos_hibernation_pred_bin_ms(i - 1), hist[i]);
+		else
+			seq_printf(s, "\t<=%5ums: %u\n", bound, hist[i]);
+	}
+
+	return 0;
+}
+
+static int hibernation_pred_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, hibernation_pred_show, inode->i_private);
+}
+
+static const struct file_operations hibernation_pred_fops = {
+	.open = hibernation_pred_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int hibernation_input_show(struct seq_file *s, void *unused)
+{
+	struct decon_device *decon = s->private;
+	struct exynos_hibernation_input *input = &decon->hibernation->input;
+	u32 events, rate_limited, exits, hits, misses, unused_cnt;
+	unsigned long flags;
+
+	spin_lock_irqsave(&input->lock, flags);
+	events = input->events;
+	rate_limited = input->rate_limited;
+	exits = input->exits;
+	hits = input->hits;
+	misses = input->misses;
+	unused_cnt = input->unused;
+	spin_unlock_irqrestore(&input->lock, flags);
+
+	seq_printf(s, "%s, ev_mask(%#x) rate_limit(%ums)\n",
+			input->registered ? "registered" : "unregistered",
+			input->ev_mask, input->rate_limit_ms);
+	seq_printf(s, "events: %u rate limited: %u exits: %u\n", events,
+			rate_limited, exits);
+	seq_printf(s, "exit before commit: %u after commit: %u unused: %u\n",
+			hits, misses, unused_cnt);
+
+	return 0;
+}
+
+static int hibernation_input_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, hibernation_input_show, inode->i_private);
+}
+
+static const struct file_operations hibernation_input_fops = {
+	.open = hibernation_input_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int hibernation_stats_show(struct seq_file *s, void *unused)
+{
+	static const char * const abort_names[HIBERNATION_ABORT_MAX] = {
+		[HIBERNATION_ABORT_BLOCKED] = "blocked",
+		[HIBERNATION_ABORT_CAMERA] = "camera",
+		[HIBERNATION_ABORT_DQE_DIMMING] = "dqe dimming",
+		[HIBERNATION_ABORT_COMMIT] = "commit",
+	};
+	struct decon_device *decon = s->private;
+	struct exynos_hibernation_stats stats;
+	u64 awake_ms, hibernated_ms, total_ms, energy_uj;
+	unsigned int i;
+
+	exynos_hibernation_get_stats(decon->hibernation, &stats);
+
+	awake_ms = div_u64(stats.awake_ns, NSEC_PER_MSEC);
+	hibernated_ms = div_u64(stats.hibernated_ns, NSEC_PER_MSEC);
+	total_ms = awake_ms + hibernated_ms;
+
+	seq_printf(s, "entry: %u exit: %u\n", stats.entry_cnt, stats.exit_cnt);
+	seq_printf(s, "awake: %llums hibernated: %llums (%llu%%)\n", awake_ms,
+			hibernated_ms,
+			total_ms ? div64_u64(hibernated_ms * 100, total_ms) : 0);
+
+	seq_puts(s, "aborted entry:");
+	for (i = 0; i < HIBERNATION_ABORT_MAX; i++)
+		seq_printf(s, " %s(%u)", abort_names[i], stats.abort_cnt[i]);
+	seq_puts(s, "\n");
+
+	seq_printf(s, "exit latency max: %uus\n", stats.exit_lat_max_us);
+	for (i = 0; i < HIBERNATION_EXIT_LAT_BIN_CNT; i++) {
+		const u32 bound = exynos_hibernation_exit_lat_bin_us(i);
+
+		if (bound == U32_MAX)
+			seq_printf(s, "\t   >%5uus: %u\n",
+				exynos_hibernation_exit_lat_bin_us(i - 1),
+				stats.exit_lat_hist[i]);
+		else
+			seq_printf(s, "\t<=%6uus: %u\n", bound,
+				stats.exit_lat_hist[i]);
+	}
+
+	/* time weighted estimate, only meaningful if power figures are set */
+	energy_uj = awake_ms * stats.awake_mw + hibernated_ms * stats.hibernated_mw +
+			(u64)stats.exit_cnt * stats.exit_uj;
+	seq_printf(s, "estimated energy: %llumJ avg power: %llumW\n",
+			div_u64(energy_uj, 1000),
+			total_ms ? div64_u64(energy_uj, total_ms) : 0);
+
+	return 0;
+}
+
+static int hibernation_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, hibernation_stats_show, inode->i_private);
+}
+
+static const struct file_operations hibernation_stats_fops = {
+	.open = hibernation_stats_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 static int recovery_show(struct seq_file *s, void *unused)
 {
 	struct decon_device *decon = s->private;
@@ -1483,8 +1640,14 @@ static ssize_t recovery_write(struct file *file, const char *user_buf,
 {
 	struct seq_file *s = file->private_data;
 	struct decon_device *decon = s->private;
+	unsigned int tier;
 
-	decon_trigger_recovery(decon);
+	/* optionally start from given tier, full modeset otherwise */
+	if (kstrtouint_from_user(user_buf, count, 0, &tier) ||
+	    tier >= EXYNOS_RECOVERY_TIER_MAX)
+		tier = EXYNOS_RECOVERY_TIER_MODESET;
+
+	decon_trigger_recovery(decon, tier);
 
 	return count;
 }
@@ -1497,6 +1660,46 @@ static const struct file_operations recovery_fops = {
 	.release = seq_release,
 };
 
+static int recovery_stats_show(struct seq_file *s, void *unused)
+{
+	struct decon_device *decon = s->private;
+	struct exynos_recovery *recovery = &decon->recovery;
+	struct exynos_recovery_tier_stats stats[EXYNOS_RECOVERY_TIER_MAX];
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&recovery->stats_lock, flags);
+	memcpy(stats, recovery->stats, sizeof(stats));
+	spin_unlock_irqrestore(&recovery->stats_lock, flags);
+
+	seq_printf(s, "recovered: %d failed: %u\n", recovery->count,
+			recovery->failures);
+	seq_printf(s, "last detection to good frame: %lluus\n",
+			recovery->last_us);
+	seq_puts(s, "tier\tattempts\tsuccesses\tavg_us\tmax_us\n");
+	for (i = 0; i < EXYNOS_RECOVERY_TIER_MAX; i++)
+		seq_printf(s, "%s\t%u\t%u\t%llu\t%llu\n",
+			exynos_recovery_tier_name(i), stats[i].attempts,
+			stats[i].successes,
+			stats[i].successes ?
+			div_u64(stats[i].total_us, stats[i].successes) : 0,
+			stats[i].max_us);
+
+	return 0;
+}
+
+static int recovery_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, recovery_stats_show, inode->i_private);
+}
+
+static const struct file_operations recovery_stats_fops = {
+	.open = recovery_stats_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 static void buf_dump_all(const struct decon_device *decon)
 {
 	struct drm_printer p = console_set_on_cmdline ?
@@ -1603,15 +1806,42 @@ int dpu_init_debug(struct decon_device *decon)
 		goto err_event_log;
 	}
 
-	if (decon->hibernation)
+	if (decon->hibernation) {
 		debugfs_create_file("hibernation", 0664, crtc->debugfs_entry, decon,
 				&hibernation_fops);
+		debugfs_create_file("hibernation_pred", 0444, crtc->debugfs_entry,
+				decon, &hibernation_pred_fops);
+		debugfs_create_u32("hibernation_exit_cost_us", 0664,
+				crtc->debugfs_entry,
+				&decon->hibernation->pred.exit_cost_us);
+		debugfs_create_file("hibernation_input", 0444, crtc->debugfs_entry,
+				decon, &hibernation_input_fops);
+		debugfs_create_x32("hibernation_input_ev_mask", 0664,
+				crtc->debugfs_entry,
+				&decon->hibernation->input.ev_mask);
+		debugfs_create_u32("hibernation_input_rate_limit_ms", 0664,
+				crtc->debugfs_entry,
+				&decon->hibernation->input.rate_limit_ms);
+		debugfs_create_file("hibernation_stats", 0444, crtc->debugfs_entry,
+				decon, &hibernation_stats_fops);
+		debugfs_create_u32("hibernation_awake_mw", 0664, crtc->debugfs_entry,
+				&decon->hibernation->stats.awake_mw);
+		debugfs_create_u32("hibernation_hibernated_mw", 0664,
+				crtc->debugfs_entry,
+				&decon->hibernation->stats.hibernated_mw);
+		debugfs_create_u32("hibernation_exit_uj", 0664, crtc->debugfs_entry,
+				&decon->hibernation->stats.exit_uj);
+	}
 
 	if (!debugfs_create_file("recovery", 0644, crtc->debugfs_entry, decon,
 				&recovery_fops)) {
 		DRM_ERROR("failed to create debugfs recovery file\n");
 		goto err_debugfs;
 	}
+	debugfs_create_file("recovery_stats", 0444, crtc->debugfs_entry, decon,
+			&recovery_stats_fops);
+	debugfs_create_atomic_t("inject_fs_drop", 0664, crtc->debugfs_entry,
+			&decon->d.inject_fs_drop);
 
 	debugfs_create_file("force_te_on", 0664, crtc->debugfs_entry, decon, &force_te_fops);
 	debugfs_create_u32("underrun_cnt", 0664, crtc->debugfs_entry, &decon->d.underrun_cnt);
@@ -1743,6 +1973,105 @@ static struct dentry *exynos_debugfs_add_tm(struct exynos_hdr *hdr,
 	return dent;
 }
 
+static int fmt_caps_show(struct seq_file *s, void *unused)
+{
+	const struct dpp_device *dpp = s->private;
+	const struct dpp_fmt_cap *fmt_cap;
+	int i, j;
+	u8 caps;
+
+	seq_puts(s, "format\tmodifier\tcaps\n");
+	for (i = 0; i < dpp->num_pixel_formats; i++) {
+		fmt_cap = dpp_get_fmt_cap(dpp, dpp->pixel_formats[i]);
+		if (!fmt_cap)
+			continue;
+
+		for (j = 0; j < DPU_MOD_CLASS_MAX; j++) {
+			caps = fmt_cap->caps[j];
+			if (!(caps & DPU_FMT_CAP_SUPPORTED))
+				continue;
+
+			seq_printf(s, "%s\t%s\t%s%s%s%s\n",
+				dpu_get_fmt_name(fmt_cap->fmt),
+				dpu_get_mod_class_name(j),
+				caps & DPU_FMT_CAP_ROT ? "rot " : "",
+				caps & DPU_FMT_CAP_SCALE ? "scale " : "",
+				caps & DPU_FMT_CAP_COMP ? "comp " : "",
+				caps & DPU_FMT_CAP_HDR ? "hdr" : "");
+		}
+	}
+
+	return 0;
+}
+
+static int fmt_caps_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, fmt_caps_show, inode->i_private);
+}
+
+static const struct file_operations fmt_caps_fops = {
+	.open = fmt_caps_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int gem_pool_show(struct seq_file *s, void *unused)
+{
+	struct exynos_drm_private *private = s->private;
+
+	exynos_drm_gem_pool_show(&private->gem_pool, s);
+
+	return 0;
+}
+
+static int gem_pool_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, gem_pool_show, inode->i_private);
+}
+
+static const struct file_operations gem_pool_fops = {
+	.open = gem_pool_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int gem_map_cache_show(struct seq_file *s, void *unused)
+{
+	struct exynos_drm_private *private = s->private;
+
+	exynos_drm_gem_map_cache_show(&private->gem_map_cache, s);
+
+	return 0;
+}
+
+static int gem_map_cache_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, gem_map_cache_show, inode->i_private);
+}
+
+static const struct file_operations gem_map_cache_fops = {
+	.open = gem_map_cache_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+void exynos_drm_debugfs_init(struct drm_minor *minor)
+{
+	struct exynos_drm_private *private = drm_to_exynos_dev(minor->dev);
+
+	debugfs_create_file("gem_pool", 0444, minor->debugfs_root, private,
+			&gem_pool_fops);
+	debugfs_create_size_t("gem_pool_max_bytes", 0664, minor->debugfs_root,
+			&private->gem_pool.max_bytes);
+	debugfs_create_file("gem_map_cache", 0444, minor->debugfs_root, private,
+			&gem_map_cache_fops);
+	debugfs_create_u32("gem_map_cache_max", 0664, minor->debugfs_root,
+			&private->gem_map_cache.max_count);
+}
+
 int exynos_drm_debugfs_plane_add(struct exynos_drm_plane *exynos_plane)
 {
 	struct drm_plane *plane = &exynos_plane->base;
@@ -1759,6 +2088,9 @@ int exynos_drm_debugfs_plane_add(struct exynos_drm_plane *exynos_plane)
 
 	exynos_plane->debugfs_entry = root;
 
+	debugfs_create_x32("inject_dma_irqs", 0664, root, &dpp->inject_irqs);
+	debugfs_create_file("fmt_caps", 0444, root, dpp, &fmt_caps_fops);
+
 	if (test_bit(DPP_ATTR_HDR, &dpp->attr)) {
 		hdr_dent = debugfs_create_dir("hdr", root);
 		if (!hdr_dent)
@@ -1989,6 +2321,186 @@ static const struct file_operations dphy_diag_reg_fops = {
 	.release = single_release,
 };
 
+static int dsim_cmd_queue_show(struct seq_file *m, void *data)
+{
+	struct dsim_device *dsim = m->private;
+	unsigned long flags;
+	u32 depth;
+
+	spin_lock_irqsave(&dsim->cmd_queue_lock, flags);
+	depth = dsim->cmd_queue_depth;
+	spin_unlock_irqrestore(&dsim->cmd_queue_lock, flags);
+
+	seq_printf(m, "depth: %u/%d (max %u)\n", depth, DSIM_CMD_QUEUE_MAX_DEPTH,
+		   dsim->cmd_queue_stats.max_depth);
+	seq_printf(m, "queued: %llu\n", dsim->cmd_queue_stats.queued);
+	seq_printf(m, "rejected: %llu\n", dsim->cmd_queue_stats.rejected);
+	seq_printf(m, "failed: %llu\n", dsim->cmd_queue_stats.failed);
+
+	return 0;
+}
+
+static int dsim_cmd_queue_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, dsim_cmd_queue_show, inode->i_private);
+}
+
+static const struct file_operations dsim_cmd_queue_fops = {
+	.owner = THIS_MODULE,
+	.open = dsim_cmd_queue_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int dsim_pktgo_show(struct seq_file *m, void *data)
+{
+	struct dsim_device *dsim = m->private;
+	const u64 waits = dsim->pktgo_stats.deferred + dsim->pktgo_stats.stale;
+
+	seq_printf(m, "in window: %llu\n", dsim->pktgo_stats.in_window);
+	seq_printf(m, "deferred to next te: %llu (late te: %llu)\n",
+		   dsim->pktgo_stats.deferred, dsim->pktgo_stats.late_te);
+	seq_printf(m, "stale vblank: %llu\n", dsim->pktgo_stats.stale);
+	seq_printf(m, "wait avg/max: %lluus/%uus\n",
+		   waits ? div64_u64(dsim->pktgo_stats.total_wait_us, waits) : 0,
+		   dsim->pktgo_stats.max_wait_us);
+
+	return 0;
+}
+
+static int dsim_pktgo_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, dsim_pktgo_show, inode->i_private);
+}
+
+static const struct file_operations dsim_pktgo_fops = {
+	.owner = THIS_MODULE,
+	.open = dsim_pktgo_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+#define DSIM_TRAFFIC_FIELD(f)	{ #f, offsetof(struct dsim_traffic_frame, f) }
+
+static const struct {
+	const char *name;
+	size_t offset;
+} dsim_traffic_fields[] = {
+	DSIM_TRAFFIC_FIELD(packets),
+	DSIM_TRAFFIC_FIELD(bytes),
+	DSIM_TRAFFIC_FIELD(forced_last),
+	DSIM_TRAFFIC_FIELD(vblank_waits),
+	DSIM_TRAFFIC_FIELD(block_us),
+};
+
+static inline u32 dsim_traffic_get(const struct dsim_traffic_frame *frame,
+				   size_t offset)
+{
+	return *(const u32 *)((const u8 *)frame + offset);
+}
+
+static int dsim_traffic_show(struct seq_file *m, void *data)
+{
+	struct dsim_device *dsim = m->private;
+	const struct dsim_traffic *t = &dsim->traffic;
+	int i, j;
+
+	mutex_lock(&dsim->cmd_lock);
+
+	seq_printf(m, "frames: %u (window %u)\n", t->num_frames,
+		   DSIM_TRAFFIC_WINDOW);
+	seq_printf(m, "%-14s %8s %8s %8s %8s\n", "", "min", "avg", "max", "cur");
+	for (i = 0; i < ARRAY_SIZE(dsim_traffic_fields); i++) {
+		const size_t offset = dsim_traffic_fields[i].offset;
+		u32 min = 0, max = 0;
+		u64 sum = 0;
+
+		for (j = 0; j < t->num_frames; j++) {
+			const u32 val = dsim_traffic_get(&t->frames[j], offset);
+
+			if (!j || val < min)
+				min = val;
+			if (val > max)
+				max = val;
+			sum += val;
+		}
+
+		seq_printf(m, "%-14s %8u %8llu %8u %8u\n",
+			   dsim_traffic_fields[i].name, min,
+			   t->num_frames ? div_u64(sum, t->num_frames) : 0, max,
+			   dsim_traffic_get(&t->cur, offset));
+	}
+
+	mutex_unlock(&dsim->cmd_lock);
+
+	return 0;
+}
+
+static ssize_t dsim_traffic_write(struct file *file, const char __user *user_buf,
+				  size_t count, loff_t *f_pos)
+{
+	struct seq_file *m = file->private_data;
+	struct dsim_device *dsim = m->private;
+
+	mutex_lock(&dsim->cmd_lock);
+	memset(&dsim->traffic, 0, sizeof(dsim->traffic));
+	mutex_unlock(&dsim->cmd_lock);
+
+	return count;
+}
+
+static int dsim_traffic_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, dsim_traffic_show, inode->i_private);
+}
+
+static const struct file_operations dsim_traffic_fops = {
+	.owner = THIS_MODULE,
+	.open = dsim_traffic_open,
+	.write = dsim_traffic_write,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int dsim_hs_clocks_show(struct seq_file *m, void *data)
+{
+	struct dsim_device *dsim = m->private;
+	const struct dsim_pll_params *pll_params = dsim->pll_params;
+	unsigned int i;
+
+	if (!pll_params)
+		return 0;
+
+	mutex_lock(&dsim->state_lock);
+	for (i = 0; i < pll_params->num_hs_clks; i++) {
+		const struct dsim_hs_clk *c = &pll_params->hs_clks[i];
+
+		seq_printf(m, "%c%uMhz p(%u) m(%u) s(%u) k(%u) dither(%d) underrun(%u) margin(%u%%)\n",
+			   c->hs_clk == dsim->clk_param.hs_clk ? '*' : ' ', c->hs_clk,
+			   c->pms.p, c->pms.m, c->pms.s, c->pms.k, c->pms.dither_en,
+			   c->cmd_underrun_cnt, c->margin);
+	}
+	mutex_unlock(&dsim->state_lock);
+
+	return 0;
+}
+
+static int dsim_hs_clocks_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, dsim_hs_clocks_show, inode->i_private);
+}
+
+static const struct file_operations dsim_hs_clocks_fops = {
+	.owner = THIS_MODULE,
+	.open = dsim_hs_clocks_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 void dsim_diag_create_debugfs(struct dsim_device *dsim) {
 	struct dentry *dent_dphy;
 	struct dentry *dent_diag;
@@ -2005,6 +2517,16 @@ void dsim_diag_create_debugfs(struct dsim_device *dsim) {
 	}
 
 	debugfs_create_u32("state", 0400, dsim->debugfs_entry, &dsim->state);
+	debugfs_create_x32("inject_int_src", 0664, dsim->debugfs_entry,
+			&dsim->inject_int_src);
+	debugfs_create_file("cmd_queue", 0400, dsim->debugfs_entry, dsim,
+			    &dsim_cmd_queue_fops);
+	debugfs_create_file("pktgo", 0400, dsim->debugfs_entry, dsim,
+			    &dsim_pktgo_fops);
+	debugfs_create_file("traffic", 0600, dsim->debugfs_entry, dsim,
+			    &dsim_traffic_fops);
+	debugfs_create_file("hs_clocks", 0400, dsim->debugfs_entry, dsim,
+			    &dsim_hs_clocks_fops);
 
 	if (dsim->config.num_dphy_diags == 0)
 		return;
@@ -15,6 +15,7 @@
 #include <drm/drm_atomic.h>
 #include <drm/drm_atomic_helper.h>
 #include <drm/drm_bridge.h>
+#include <drm/drm_debugfs_crc.h>
 #include <drm/drm_vblank.h>
 #include <drm/exynos_drm.h>
 
@@ -78,6 +79,8 @@ static void decon_seamless_mode_set(struct exynos_drm_crtc *exynos_crtc,
 static int decon_request_te_irq(struct exynos_drm_crtc *exynos_crtc,
 				const struct exynos_drm_connector_state *exynos_conn_state);
 static bool decon_check_fs_pending_locked(struct decon_device *decon);
+static void decon_recovery_reset(struct decon_device *decon,
+				 const struct drm_crtc_state *crtc_state);
 
 #define FRAME_TIMEOUT msecs_to_jiffies(100)
 
@@ -540,6 +543,7 @@ static void decon_atomic_begin(struct exynos_drm_crtc *crtc)
 
 	decon_debug(decon, "%s +\n", __func__);
 	DPU_EVENT_LOG(DPU_EVT_ATOMIC_BEGIN, decon->id, NULL);
+	decon_recovery_reset(decon, crtc->base.state);
 	decon_reg_wait_update_done_and_mask(decon->id, &decon->config.mode,
 			SHADOW_UPDATE_TIMEOUT_US);
 	decon_debug(decon, "%s -\n", __func__);
@@ -824,7 +828,7 @@ static void decon_atomic_flush(struct exynos_drm_crtc *exynos_crtc,
 		 */
 		if (!new_crtc_state->no_vblank) {
 			exynos_crtc_handle_event(exynos_crtc);
-			if (decon->fb_handover.rmem) {
+			if (exynos_fb_handover_pending(&decon->fb_handover)) {
 				decon_force_vblank_event(decon);
 				drm_crtc_handle_vblank(&decon->crtc->base);
 			}
@@ -835,6 +839,8 @@ static void decon_atomic_flush(struct exynos_drm_crtc *exynos_crtc,
 
 	if (new_exynos_crtc_state->wb_type == EXYNOS_WB_CWB)
 		decon_reg_set_cwb_enable(decon->id, true);
+	else if (writeback_stream_arm(decon_get_wb(decon), new_crtc_state))
+		decon_debug(decon, "cwb stream armed\n");
 	else if (old_exynos_crtc_state->wb_type == EXYNOS_WB_CWB)
 		decon_reg_set_cwb_enable(decon->id, false);
 
@@ -947,10 +953,83 @@ static void decon_enable_irqs(struct decon_device *decon)
 		enable_irq(decon->irq_de);
 }
 
+/* CRC is calculated by DSIMIF connected to DECON output */
+static int decon_get_crc_dsimif(const struct decon_device *decon)
+{
+	switch (decon->config.out_type) {
+	case DECON_OUT_DSI0:
+	case DECON_OUT_DSI:
+		return 0;
+	case DECON_OUT_DSI1:
+		return 1;
+	default:
+		return -EINVAL;
+	}
+}
+
+static void decon_start_crc_locked(struct decon_device *decon, bool enable)
+{
+	const int dsimif = decon_get_crc_dsimif(decon);
+
+	if (dsimif < 0)
+		return;
+
+	/* first frame after start may not be fully covered */
+	decon->crc_skip = 1;
+	decon_reg_set_start_crc(dsimif, enable);
+}
+
+static void decon_handle_crc_locked(struct decon_device *decon)
+{
+	struct drm_crtc *crtc = &decon->crtc->base;
+	const int dsimif = decon_get_crc_dsimif(decon);
+	u32 crcs[3];
+
+	if (dsimif < 0)
+		return;
+
+	if (decon->crc_skip) {
+		decon->crc_skip--;
+		return;
+	}
+
+	decon_reg_get_crc_data(dsimif, crcs);
+	drm_crtc_add_crc_entry(crtc, true, drm_crtc_vblank_count(crtc), crcs);
+}
+
+static int decon_set_crc_source(struct exynos_drm_crtc *crtc, bool enable)
+{
+	struct decon_device *decon = crtc->ctx;
+	unsigned long flags;
+
+	if (enable && decon->state == DECON_STATE_ON &&
+	    decon_get_crc_dsimif(decon) < 0)
+		return -EINVAL;
+
+	spin_lock_irqsave(&decon->slock, flags);
+	decon->crc_enabled = enable;
+	/* otherwise it's started on next enable */
+	if (decon->state == DECON_STATE_ON)
+		decon_start_crc_locked(decon, enable);
+	spin_unlock_irqrestore(&decon->slock, flags);
+
+	decon_debug(decon, "crc %s\n", enable ? "enabled" : "disabled");
+
+	return 0;
+}
+
 static void _decon_enable(struct decon_device *decon)
 {
+	unsigned long flags;
+
 	decon->state = DECON_STATE_ON;
 	decon_reg_init(decon->id, &decon->config);
+
+	spin_lock_irqsave(&decon->slock, flags);
+	if (decon->crc_enabled)
+		decon_start_crc_locked(decon, true);
+	spin_unlock_irqrestore(&decon->slock, flags);
+
 	decon_enable_irqs(decon);
 }
 
@@ -1172,8 +1251,21 @@ static void _decon_stop(struct decon_device *decon, bool reset, u32 vrefresh)
 		exynos_dqe_reset(decon->dqe);
 }
 
+static ktime_t decon_trace_exit_phase(const struct decon_device *decon,
+			const char *phase, ktime_t start)
+{
+	const ktime_t now = ktime_get();
+
+	trace_dpu_hibernation_exit_phase(decon->id, phase,
+			ktime_us_delta(now, start));
+
+	return now;
+}
+
 static void decon_exit_hibernation(struct decon_device *decon)
 {
+	ktime_t start, ts;
+
 	if (decon->state != DECON_STATE_HIBERNATION)
 		return;
 
@@ -1181,13 +1273,29 @@ static void decon_exit_hibernation(struct decon_device *decon)
 	DPU_ATRACE_BEGIN(__func__);
 	decon_debug(decon, "%s +\n", __func__);
 
+	exynos_hibernation_stats_exit(decon->hibernation);
+
+	start = ktime_get();
 	pm_runtime_get_sync(decon->dev);
+	ts = decon_trace_exit_phase(decon, "power_on", start);
+
+	/*
+	 * DSIM PHY power on and PLL lock don't depend on DECON registers, let
+	 * them run while DECON and DQE registers are restored. DSIM runtime
+	 * resume from encoder enable waits for it to finish.
+	 */
+	dsim_exit_ulps_async(decon_get_dsim(decon));
+
 	_decon_enable(decon);
+	ts = decon_trace_exit_phase(decon, "decon_restore", ts);
 
 	exynos_dqe_restore_lpd_data(decon->dqe);
 
 	if (decon->partial)
 		exynos_partial_restore(decon->partial);
+	decon_trace_exit_phase(decon, "dqe_partial_restore", ts);
+
+	decon_trace_exit_phase(decon, "decon_total", start);
 
 	decon_debug(decon, "%s -\n", __func__);
 	DPU_ATRACE_END(__func__);
@@ -1258,6 +1366,7 @@ static void decon_enable(struct exynos_drm_crtc *exynos_crtc, struct drm_crtc_st
 	}
 
 	_decon_enable(decon);
+	exynos_hibernation_stats_power(decon->hibernation, true);
 
 	decon_print_config_info(decon);
 
@@ -1337,6 +1446,47 @@ static void _decon_disable(struct decon_device *decon)
 	decon->state = DECON_STATE_HIBERNATION;
 }
 
+/*
+ * Lightweight recovery, reset only the faulted blocks while keeping DSIM and
+ * panel on. The state is fully repainted right after since recovery adds all
+ * planes and color management to the commit.
+ */
+static void decon_recovery_reset(struct decon_device *decon,
+				 const struct drm_crtc_state *crtc_state)
+{
+	const struct exynos_drm_crtc_state *exynos_crtc_state =
+					to_exynos_crtc_state(crtc_state);
+	int i;
+
+	if (exynos_crtc_state->recovery_reset) {
+		decon_warn(decon, "recovery: reset decon\n");
+
+		decon_disable_irqs(decon);
+		atomic_set(&decon->frames_pending, 0);
+		_decon_stop(decon, true, drm_mode_vrefresh(&crtc_state->mode));
+		_decon_enable(decon);
+
+		exynos_dqe_restore_lpd_data(decon->dqe);
+
+		if (decon->partial)
+			exynos_partial_restore(decon->partial);
+
+		/* all dpps have been disabled as part of decon stop */
+		return;
+	}
+
+	for (i = 0; i < decon->dpp_cnt; ++i) {
+		struct dpp_device *dpp = decon->dpp[i];
+
+		if (!test_bit(dpp->id, &exynos_crtc_state->recovery_dpp_mask) ||
+		    dpp->decon_id != decon->id)
+			continue;
+
+		decon_warn(decon, "recovery: reinit dpp%d\n", dpp->id);
+		_dpp_disable(dpp);
+	}
+}
+
 static void decon_enter_hibernation(struct decon_device *decon)
 {
 	if (decon->state != DECON_STATE_ON)
@@ -1350,6 +1500,8 @@ static void decon_enter_hibernation(struct decon_device *decon)
 	_decon_disable(decon);
 	pm_runtime_put_sync(decon->dev);
 
+	exynos_hibernation_stats_enter(decon->hibernation);
+
 	DPU_EVENT_LOG(DPU_EVT_ENTER_HIBERNATION_OUT, decon->id, NULL);
 	DPU_ATRACE_END(__func__);
 
@@ -1391,6 +1543,7 @@ static void decon_disable(struct exynos_drm_crtc *crtc)
 	}
 
 	decon->state = DECON_STATE_OFF;
+	exynos_hibernation_stats_power(decon->hibernation, false);
 	if (old_decon_state == DECON_STATE_ON)
 		pm_runtime_put_sync(decon->dev);
 
@@ -1439,7 +1592,9 @@ static void decon_wait_for_flip_done(struct exynos_drm_crtc *crtc,
 			decon_force_vblank_event(decon);
 
 			if (!recovering)
-				decon_trigger_recovery(decon);
+				decon_trigger_recovery(decon, EXYNOS_RECOVERY_TIER_DECON);
+			else
+				decon_report_recovery_fault(decon);
 		} else {
 			pr_warn("decon%u scheduler late to service fs irq handle (%d fps)\n",
 					decon->id, fps);
@@ -1464,6 +1619,7 @@ static const struct exynos_drm_crtc_ops decon_crtc_ops = {
 	.disable_plane = decon_disable_plane,
 	.atomic_flush = decon_atomic_flush,
 	.wait_for_flip_done = decon_wait_for_flip_done,
+	.set_crc_source = decon_set_crc_source,
 };
 
 static int dpu_sysmmu_fault_handler(struct iommu_fault *fault, void *data)
@@ -1606,6 +1762,8 @@ static irqreturn_t decon_irq_handler(int irq, void *dev_data)
 			handle_histogram_event(decon->dqe);
 		atomic_dec_if_positive(&decon->frames_pending);
 		wake_up_all(&decon->framedone_wait);
+		if (decon->crc_enabled)
+			decon_handle_crc_locked(decon);
 		decon_debug(decon, "%s: frame done\n", __func__);
 	}
 
@@ -1650,6 +1808,12 @@ static bool decon_check_fs_pending_locked(struct decon_device *decon)
 
 	pending_irq = decon_reg_get_fs_interrupt_and_clear(decon->id);
 
+	if ((pending_irq & DPU_FRAME_START_INT_PEND) &&
+	    atomic_dec_if_positive(&decon->d.inject_fs_drop) >= 0) {
+		decon_warn(decon, "injected frame start drop\n");
+		return false;
+	}
+
 	if (pending_irq & DPU_FRAME_START_INT_PEND) {
 		DPU_EVENT_LOG(DPU_EVT_DECON_FRAMESTART, decon->id, decon);
 		decon_send_vblank_event_locked(decon);
@@ -127,6 +127,21 @@ struct decon_win_config {
 	dma_addr_t dma_addr;
 };
 
+/* precomputed ACLK needed for rotation, see dpu_bts_update_rot_lut() */
+struct dpu_bts_rot_lut {
+	/* parameters the table was built with */
+	u32 fps;
+	u32 vblank_t_ns;
+	u32 image_width;
+	u32 ppc;
+	bool is_dsc;
+	u32 dfs_lv_cnt;
+	/* count of source width buckets */
+	u32 width_cnt;
+	/* needed clock in kHz indexed by [width bucket][is_comp][dfs level] */
+	u32 *need_khz;
+};
+
 struct dpu_bts {
 	bool enabled;
 	u32 resol_clk;
@@ -178,6 +193,7 @@ struct dpu_bts {
 	struct dpu_bts_win_config wb_config;
 	struct decon_win_config rcd_win_config;
 	atomic_t delayed_update;
+	struct dpu_bts_rot_lut rot_lut;
 };
 
 /**
@@ -427,6 +443,9 @@ struct decon_debug {
 
 	u32 te_cnt;
 	bool force_te_on;
+
+	/* fault injection: count of frame start interrupts to be dropped */
+	atomic_t inject_fs_drop;
 };
 
 struct decon_device {
@@ -477,6 +496,11 @@ struct decon_device {
 
 	bool keep_unmask;
 	struct exynos_partial *partial;
+
+	/* per frame output CRC reported through drm crtc crc interface */
+	bool crc_enabled;
+	/* frames to skip after CRC start, until a full frame is calculated */
+	u32 crc_skip;
 };
 
 extern struct dpu_bts_ops dpu_bts_control;
@@ -590,12 +614,31 @@ static inline bool is_power_on(struct drm_device *drm_dev)
 	return ret;
 }
 
-static inline void decon_trigger_recovery(struct decon_device *decon)
+static inline void decon_report_recovery_fault(struct decon_device *decon)
+{
+	atomic_inc(&decon->recovery.fault_cnt);
+}
+
+static inline void decon_trigger_recovery(struct decon_device *decon,
+					  enum exynos_recovery_tier tier)
 {
 	struct exynos_recovery *recovery = &decon->recovery;
 
-	atomic_inc(&recovery->recovering);
+	decon_report_recovery_fault(decon);
+	if (atomic_inc_return(&recovery->recovering) == 1)
+		recovery->detect_time = ktime_get();
+	set_bit(tier, &recovery->req_tiers);
 	queue_work(system_highpri_wq, &recovery->work);
 }
 
+static inline void decon_report_dpp_fault(struct decon_device *decon, u32 dpp_id)
+{
+	set_bit(dpp_id, &decon->recovery.dpp_fault_mask);
+
+	if (atomic_read(&decon->recovery.recovering))
+		decon_report_recovery_fault(decon);
+	else
+		decon_trigger_recovery(decon, EXYNOS_RECOVERY_TIER_DPP);
+}
+
 #endif /* __EXYNOS_DRM_DECON_H__ */
@@ -621,7 +621,7 @@ static int dpp_disable(struct dpp_device *this_dpp)
 }
 
 static int dpp_check_scale(struct dpp_device *dpp,
-			struct dpp_params_info *config)
+			struct dpp_params_info *config, u8 caps)
 {
 	struct dpp_restriction *res;
 	struct decon_frame *src, *dst;
@@ -644,7 +644,7 @@ static int dpp_check_scale(struct dpp_device *dpp,
 		return 0;
 
 	/* Scaling is requested. need to check limitation */
-	if (!test_bit(DPP_ATTR_CSC, &dpp->attr)) {
+	if (!(caps & DPU_FMT_CAP_SCALE)) {
 		dpp_err(dpp, "not support CSC\n");
 		return -ENOTSUPP;
 	}
@@ -666,16 +666,14 @@ static int dpp_check_scale(struct dpp_device *dpp,
 }
 
 static int dpp_check_size(struct dpp_device *dpp,
-			struct dpp_params_info *config)
+			struct dpp_params_info *config,
+			const struct dpu_fmt *fmt_info)
 {
 	struct decon_frame *src, *dst;
-	const struct dpu_fmt *fmt_info;
 	struct dpp_restriction *res;
 	u32 mul = 1; /* factor to multiply alignment */
 	u32 src_h_max;
 
-	fmt_info = dpu_find_fmt_info(config->format);
-
 	if (IS_YUV(fmt_info))
 		mul = 2;
 
@@ -756,11 +754,24 @@ static int dpp_check_dst_size(struct dpp_device *dpp,
 	return 0;
 }
 
+static enum dpu_mod_class dpp_comp_type_to_mod_class(enum dpp_comp_type type)
+{
+	switch (type) {
+	case COMP_TYPE_AFBC:
+		return DPU_MOD_CLASS_AFBC;
+	case COMP_TYPE_SBWC:
+		return DPU_MOD_CLASS_SBWC;
+	default:
+		return DPU_MOD_CLASS_LINEAR;
+	}
+}
+
 static int dpp_check(struct dpp_device *dpp,
 		const struct exynos_drm_plane_state *state)
 {
 	struct dpp_params_info config;
-	const struct dpu_fmt *fmt_info;
+	const struct dpp_fmt_cap *fmt_cap;
+	u8 caps;
 	const struct drm_plane_state *plane_state = &state->base;
 	const struct drm_crtc_state *crtc_state =
 			drm_atomic_get_new_crtc_state(plane_state->state,
@@ -781,23 +792,25 @@ static int dpp_check(struct dpp_device *dpp,
 		return 0;
 	}
 
-	if (dpp_check_scale(dpp, &config))
-		goto err;
-
-	if (dpp_check_size(dpp, &config))
+	fmt_cap = dpp_get_fmt_cap(dpp, config.format);
+	caps = fmt_cap ?
+		fmt_cap->caps[dpp_comp_type_to_mod_class(config.comp_type)] : 0;
+	if (!(caps & DPU_FMT_CAP_SUPPORTED)) {
+		dpp_err(dpp, "not support format with comp_type %d\n",
+				config.comp_type);
 		goto err;
+	}
 
-	fmt_info = dpu_find_fmt_info(config.format);
-	if ((config.rot & DPP_ROT) && (!IS_YUV420(fmt_info))) {
+	if ((config.rot & DPP_ROT) && !(caps & DPU_FMT_CAP_ROT)) {
 		dpp_err(dpp, "support rotation only for YUV420 format\n");
 		goto err;
 	}
 
-	if (!test_bit(DPP_ATTR_AFBC, &dpp->attr) &&
-			(config.comp_type == COMP_TYPE_AFBC)) {
-		dpp_err(dpp, "not support AFBC\n");
+	if (dpp_check_scale(dpp, &config, caps))
+		goto err;
+
+	if (dpp_check_size(dpp, &config, fmt_cap->fmt))
 		goto err;
-	}
 
 	if (__dpp_check(dpp->id, &config, dpp->attr))
 		goto err;
@@ -1032,6 +1045,77 @@ static void dpp_print_restriction(struct dpp_device *dpp)
 			res->scale_down);
 }
 
+static u8 dpp_get_fmt_caps(const struct dpp_device *dpp,
+		const struct dpu_fmt *fmt, enum dpu_mod_class mod_class)
+{
+	u8 caps = DPU_FMT_CAP_SUPPORTED;
+
+	switch (mod_class) {
+	case DPU_MOD_CLASS_AFBC:
+		/*
+		 * ARGB2101010 and ABGR2101010 are not supported by AFBC decoder,
+		 * refer to __dpp_check() for the endianness notes.
+		 */
+		if (!test_bit(DPP_ATTR_AFBC, &dpp->attr) ||
+				fmt->fmt == DRM_FORMAT_ARGB2101010 ||
+				fmt->fmt == DRM_FORMAT_ABGR2101010)
+			return 0;
+		caps |= DPU_FMT_CAP_COMP;
+		break;
+	case DPU_MOD_CLASS_SBWC:
+		if (!test_bit(DPP_ATTR_SBWC, &dpp->attr) || IS_RGB(fmt))
+			return 0;
+		caps |= DPU_FMT_CAP_COMP;
+		break;
+	default:
+		break;
+	}
+
+	if (test_bit(DPP_ATTR_ROT, &dpp->attr) && IS_YUV420(fmt))
+		caps |= DPU_FMT_CAP_ROT;
+	if (test_bit(DPP_ATTR_CSC, &dpp->attr))
+		caps |= DPU_FMT_CAP_SCALE;
+	if (test_bit(DPP_ATTR_HDR, &dpp->attr))
+		caps |= DPU_FMT_CAP_HDR;
+
+	return caps;
+}
+
+/*
+ * Folds format table, DPP attributes and format specific restrictions into a
+ * single lookup so that atomic check doesn't have to walk the format list.
+ */
+static void dpp_init_fmt_caps(struct dpp_device *dpp)
+{
+	struct dpp_fmt_cap *fmt_cap;
+	const struct dpu_fmt *fmt;
+	unsigned int i, j;
+	u32 slot;
+
+	BUILD_BUG_ON(DPP_FMT_CAP_SLOTS <= ARRAY_SIZE(dpp_vg_formats));
+
+	memset(dpp->fmt_caps, 0, sizeof(dpp->fmt_caps));
+
+	for (i = 0; i < dpp->num_pixel_formats; i++) {
+		fmt = dpu_find_fmt_info(dpp->pixel_formats[i]);
+		if (!fmt) {
+			dpp_warn(dpp, "no format info for 0x%08x\n",
+					dpp->pixel_formats[i]);
+			continue;
+		}
+
+		slot = hash_32(fmt->fmt, DPP_FMT_CAP_ORDER);
+		while (dpp->fmt_caps[slot].fourcc)
+			slot = (slot + 1) & (DPP_FMT_CAP_SLOTS - 1);
+
+		fmt_cap = &dpp->fmt_caps[slot];
+		fmt_cap->fourcc = fmt->fmt;
+		fmt_cap->fmt = fmt;
+		for (j = 0; j < DPU_MOD_CLASS_MAX; j++)
+			fmt_cap->caps[j] = dpp_get_fmt_caps(dpp, fmt, j);
+	}
+}
+
 static int exynos_dpp_parse_dt(struct dpp_device *dpp, struct device_node *np)
 {
 	int ret = 0;
@@ -1065,6 +1149,8 @@ static int exynos_dpp_parse_dt(struct dpp_device *dpp, struct device_node *np)
 
 	dpp_print_restriction(dpp);
 
+	dpp_init_fmt_caps(dpp);
+
 	return 0;
 fail:
 	return ret;
@@ -1099,6 +1185,7 @@ static irqreturn_t dma_irq_handler(int irq, void *priv)
 
 	/* IDMA case */
 	irqs = idma_reg_get_irq_and_clear(dpp->id);
+	irqs |= xchg(&dpp->inject_irqs, 0);
 
 	if (irqs & IDMA_RECOVERY_START_IRQ) {
 		DPU_EVENT_LOG(DPU_EVT_DMA_RECOVERY, dpp->decon_id, dpp);
@@ -1142,6 +1229,13 @@ static irqreturn_t dma_irq_handler(int irq, void *priv)
 		dump = true;
 	}
 
+	if (dump) {
+		struct decon_device *decon = get_decon_drvdata(dpp->decon_id);
+
+		if (decon)
+			decon_report_dpp_fault(decon, dpp->id);
+	}
+
 	if (dump && time_after(jiffies, last_dumptime + msecs_to_jiffies(5000))) {
 		struct decon_device *decon = get_decon_drvdata(dpp->decon_id);
 		if (decon) {
@@ -15,11 +15,13 @@
 #define _EXYNOS_DRM_DPP_H_
 
 #include <drm/samsung_drm.h>
+#include <linux/hash.h>
 
 #include <dpp_cal.h>
 
 #include "exynos_drm_drv.h"
 #include "exynos_drm_dqe.h"
+#include "exynos_drm_format.h"
 
 enum EXYNOS9_DPP_FEATURES {
 	/* Can reads the graphical image */
@@ -67,6 +69,19 @@ struct exynos_hdr {
 	struct tm_debug_override tm;
 };
 
+/*
+ * Format capability matrix built per DPP at bind time, open addressed by
+ * fourcc. Must be a power of two larger than any supported format list.
+ */
+#define DPP_FMT_CAP_ORDER	5
+#define DPP_FMT_CAP_SLOTS	(1 << DPP_FMT_CAP_ORDER)
+
+struct dpp_fmt_cap {
+	u32 fourcc;
+	const struct dpu_fmt *fmt;
+	u8 caps[DPU_MOD_CLASS_MAX];
+};
+
 struct dpp_device {
 	struct device *dev;
 
@@ -81,6 +96,7 @@ struct dpp_device {
 
 	const uint32_t *pixel_formats;
 	unsigned int num_pixel_formats;
+	struct dpp_fmt_cap fmt_caps[DPP_FMT_CAP_SLOTS];
 
 	struct dpp_regs	regs;
 	struct dpp_params_info win_config;
@@ -105,6 +121,8 @@ struct dpp_device {
 	 */
 	u64 comp_src;
 	u32 recovery_cnt;
+	/* fault injection: IDMA irq bits reported along with next dma irq */
+	u32 inject_irqs;
 
 	struct dpp_restriction restriction;
 
@@ -140,6 +158,18 @@ static struct dpp_device *of_find_dpp_by_node(struct device_node *np)
 }
 #endif
 
+static inline const struct dpp_fmt_cap *
+dpp_get_fmt_cap(const struct dpp_device *dpp, u32 fourcc)
+{
+	u32 i = hash_32(fourcc, DPP_FMT_CAP_ORDER);
+
+	for (; dpp->fmt_caps[i].fourcc; i = (i + 1) & (DPP_FMT_CAP_SLOTS - 1))
+		if (dpp->fmt_caps[i].fourcc == fourcc)
+			return &dpp->fmt_caps[i];
+
+	return NULL;
+}
+
 void dpp_dump(struct drm_printer *p, struct dpp_device *dpp);
 void rcd_dump(struct drm_printer *p, struct dpp_device *dpp);
 void dpp_dump_buffer(struct drm_printer *p, struct dpp_device *dpp);
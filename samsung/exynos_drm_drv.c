@@ -830,12 +830,47 @@ static void exynos_drm_postclose(struct drm_device *dev, struct drm_file *file)
 	file->driver_priv = NULL;
 }
 
+/* extension uapi must stay clear of numbers taken by samsung_drm.h */
+static_assert(DRM_IOCTL_NR(DRM_IOCTL_EXYNOS_HISTOGRAM_REQUEST) !=
+	      DRM_COMMAND_BASE + DRM_EXYNOS_WB_STREAM_START &&
+	      DRM_IOCTL_NR(DRM_IOCTL_EXYNOS_HISTOGRAM_REQUEST) !=
+	      DRM_COMMAND_BASE + DRM_EXYNOS_WB_STREAM_STOP);
+static_assert(DRM_IOCTL_NR(DRM_IOCTL_EXYNOS_HISTOGRAM_CANCEL) !=
+	      DRM_COMMAND_BASE + DRM_EXYNOS_WB_STREAM_START &&
+	      DRM_IOCTL_NR(DRM_IOCTL_EXYNOS_HISTOGRAM_CANCEL) !=
+	      DRM_COMMAND_BASE + DRM_EXYNOS_WB_STREAM_STOP);
+static_assert(DRM_IOCTL_NR(DRM_IOCTL_EXYNOS_HISTOGRAM_REQUEST) !=
+	      DRM_COMMAND_BASE + DRM_EXYNOS_FB_HANDOVER &&
+	      DRM_IOCTL_NR(DRM_IOCTL_EXYNOS_HISTOGRAM_CANCEL) !=
+	      DRM_COMMAND_BASE + DRM_EXYNOS_FB_HANDOVER);
+static_assert(DRM_IOCTL_NR(DRM_IOCTL_EXYNOS_HISTOGRAM_REQUEST) !=
+	      DRM_COMMAND_BASE + DRM_EXYNOS_WB_STREAM_RELEASE &&
+	      DRM_IOCTL_NR(DRM_IOCTL_EXYNOS_HISTOGRAM_CANCEL) !=
+	      DRM_COMMAND_BASE + DRM_EXYNOS_WB_STREAM_RELEASE);
+static_assert(EXYNOS_DRM_HISTOGRAM_EVENT != EXYNOS_DRM_WB_STREAM_EVENT);
 
 static const struct drm_ioctl_desc exynos_ioctls[] = {
 	DRM_IOCTL_DEF_DRV(EXYNOS_HISTOGRAM_REQUEST, histogram_request_ioctl, 0),
 	DRM_IOCTL_DEF_DRV(EXYNOS_HISTOGRAM_CANCEL, histogram_cancel_ioctl, 0),
+	DRM_IOCTL_DEF_DRV(EXYNOS_WB_STREAM_START, exynos_wb_stream_start_ioctl, 0),
+	DRM_IOCTL_DEF_DRV(EXYNOS_WB_STREAM_STOP, exynos_wb_stream_stop_ioctl, 0),
+	DRM_IOCTL_DEF_DRV(EXYNOS_FB_HANDOVER, exynos_drm_fb_handover_ioctl, DRM_MASTER),
+	DRM_IOCTL_DEF_DRV(EXYNOS_WB_STREAM_RELEASE, exynos_wb_stream_release_ioctl, 0),
 };
 
+static int exynos_drm_release(struct inode *inode, struct file *filp)
+{
+	struct drm_file *file = filp->private_data;
+
+	/*
+	 * Stop streams of this file before drm_release() drops its pending
+	 * events, postclose is too late as events could be queued in between.
+	 */
+	exynos_wb_stream_release(file->minor->dev, file);
+
+	return drm_release(inode, filp);
+}
+
 static const struct file_operations exynos_drm_driver_fops = {
 	.owner		= THIS_MODULE,
 	.open		= drm_open,
@@ -844,7 +879,7 @@ static const struct file_operations exynos_drm_driver_fops = {
 	.read		= drm_read,
 	.unlocked_ioctl	= drm_ioctl,
 	.compat_ioctl	= drm_compat_ioctl,
-	.release	= drm_release,
+	.release	= exynos_drm_release,
 };
 
 static struct drm_driver exynos_drm_driver = {
@@ -858,10 +893,12 @@ static struct drm_driver exynos_drm_driver = {
 	.dumb_map_offset	   = exynos_drm_gem_dumb_map_offset,
 	.prime_handle_to_fd	   = drm_gem_prime_handle_to_fd,
 	.prime_fd_to_handle	   = drm_gem_prime_fd_to_handle,
+	.gem_prime_export	   = exynos_drm_gem_prime_export,
 	.gem_prime_import	   = exynos_drm_gem_prime_import,
 	.gem_prime_import_sg_table = exynos_drm_gem_prime_import_sg_table,
 	.ioctls			   = exynos_ioctls,
 	.num_ioctls		   = ARRAY_SIZE(exynos_ioctls),
+	.debugfs_init		   = exynos_drm_debugfs_init,
 	.fops			   = &exynos_drm_driver_fops,
 	.name			   = DRIVER_NAME,
 	.desc			   = DRIVER_DESC,
@@ -968,6 +1005,16 @@ static int exynos_drm_bind(struct device *dev)
 	if (ret)
 		return ret;
 
+	ret = exynos_drm_gem_pool_init(&private->gem_pool);
+	if (ret)
+		return ret;
+
+	ret = exynos_drm_gem_map_cache_init(&private->gem_map_cache);
+	if (ret) {
+		exynos_drm_gem_pool_fini(&private->gem_pool);
+		return ret;
+	}
+
 	exynos_drm_mode_config_init(drm);
 
 	/* create properties ahead of binding to make them available to all drivers */
@@ -1049,6 +1096,8 @@ err_unbind_all:
 err_priv_state_cleanup:
 	drm_atomic_private_obj_fini(&private->obj);
 err_free_drm:
+	exynos_drm_gem_map_cache_fini(&private->gem_map_cache);
+	exynos_drm_gem_pool_fini(&private->gem_pool);
 	drm_dev_put(drm);
 
 	return ret;
@@ -1070,6 +1119,9 @@ static void exynos_drm_unbind(struct device *dev)
 
 	component_unbind_all(dev, drm);
 
+	exynos_drm_gem_map_cache_fini(&private->gem_map_cache);
+	exynos_drm_gem_pool_fini(&private->gem_pool);
+
 	drm_dev_put(drm);
 }
 
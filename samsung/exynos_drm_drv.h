@@ -29,6 +29,7 @@
 
 #include "exynos_drm_connector.h"
 #include "exynos_drm_dqe.h"
+#include "exynos_drm_gem.h"
 
 #define MAX_CRTC	3
 #define MAX_PLANE	MAX_WIN_PER_DECON
@@ -229,6 +230,7 @@ struct exynos_drm_crtc_ops {
 	void (*wait_for_flip_done)(struct exynos_drm_crtc *crtc,
 			const struct drm_crtc_state *old_crtc_state,
 			const struct drm_crtc_state *new_crtc_state);
+	int (*set_crc_source)(struct exynos_drm_crtc *crtc, bool enable);
 };
 
 struct exynos_drm_crtc_state {
@@ -273,6 +275,18 @@ struct exynos_drm_crtc_state {
 	 */
 	u8 hibernation_exit : 1;
 
+	/**
+	 * @recovery_reset: set by recovery to stop and reinit DECON before
+	 *		    repainting the current state
+	 */
+	u8 recovery_reset : 1;
+
+	/**
+	 * @recovery_dpp_mask: mask of DPP ids which should be reinitialized by
+	 *		       recovery before repainting the current state
+	 */
+	unsigned long recovery_dpp_mask;
+
 	unsigned int reserved_win_mask;
 	unsigned int visible_win_mask;
 	struct drm_rect partial_region;
@@ -374,6 +388,9 @@ struct exynos_drm_private {
 
 	struct exynos_drm_connector_properties connector_props;
 	struct drm_private_obj	obj;
+
+	struct exynos_drm_gem_pool gem_pool;
+	struct exynos_drm_gem_map_cache gem_map_cache;
 };
 
 #define drm_to_exynos_dev(dev) container_of(dev, struct exynos_drm_private, drm)
@@ -399,6 +416,7 @@ static inline int exynos_dpi_bind(struct drm_device *dev,
 int exynos_atomic_commit(struct drm_device *dev, struct drm_atomic_state *state,
 			 bool nonblock);
 int exynos_atomic_check(struct drm_device *dev, struct drm_atomic_state *state);
+void exynos_drm_debugfs_init(struct drm_minor *minor);
 int exynos_atomic_enter_tui(void);
 int exynos_atomic_exit_tui(void);
 
@@ -37,6 +37,8 @@
 #include <linux/regulator/consumer.h>
 #include <linux/component.h>
 #include <linux/iommu.h>
+#include <linux/sort.h>
+#include <uapi/linux/sched/types.h>
 
 #include <video/mipi_display.h>
 
@@ -111,8 +113,12 @@ static const struct of_device_id dsim_of_match[] = {
 };
 MODULE_DEVICE_TABLE(of, dsim_of_match);
 
+static int __dsim_calc_underrun(const struct dsim_reg_config *config, uint32_t hs_clock_mhz,
+		uint32_t *underrun, uint32_t *margin);
 static int dsim_calc_underrun(const struct dsim_device *dsim, uint32_t hs_clock_mhz,
 		uint32_t *underrun);
+static int dsim_calc_pmsk(struct dsim_pll_features *pll_features,
+			 struct stdphy_pms *pms, unsigned int hs_clock_mhz);
 
 static struct drm_crtc *drm_encoder_get_new_crtc(struct drm_encoder *encoder,
 						 struct drm_atomic_state *state)
@@ -253,6 +259,34 @@ static void _dsim_exit_ulps_locked(struct dsim_device *dsim)
 	DPU_ATRACE_END(__func__);
 }
 
+static void dsim_ulps_exit_work(struct work_struct *work)
+{
+	struct dsim_device *dsim = container_of(work, struct dsim_device,
+			ulps_exit_work);
+	const struct decon_device *decon = dsim_get_decon(dsim);
+	const ktime_t start = ktime_get();
+
+	/*
+	 * PHY power on and ULPS exit are done by runtime resume, so that the PHY
+	 * is never touched while dsim is suspended. Encoder enable waits for a
+	 * resume still in progress.
+	 */
+	pm_runtime_get_sync(dsim->dev);
+	pm_runtime_mark_last_busy(dsim->dev);
+	pm_runtime_put_autosuspend(dsim->dev);
+
+	trace_dpu_hibernation_exit_phase(decon ? decon->id : -1, "dsim_ulps_exit",
+			ktime_us_delta(ktime_get(), start));
+}
+
+void dsim_exit_ulps_async(struct dsim_device *dsim)
+{
+	if (!dsim)
+		return;
+
+	queue_work(system_highpri_wq, &dsim->ulps_exit_work);
+}
+
 static void dsim_set_te_pinctrl(struct dsim_device *dsim, bool en)
 {
 	int ret;
@@ -507,6 +541,7 @@ static void dsim_modes_release(struct dsim_pll_params *pll_params)
 			kfree(pll_params->params[i]);
 		kfree(pll_params->params);
 	}
+	kfree(pll_params->hs_clks);
 	kfree(pll_params->features);
 
 	kfree(pll_params);
@@ -582,20 +617,124 @@ static void dsim_update_clock_config(struct dsim_device *dsim,
 	dsim_debug(dsim, "\tunderrun_lp_ref 0x%x\n", dsim->config.cmd_underrun_cnt[0]);
 }
 
+static struct dsim_hs_clk *
+dsim_find_hs_clk(const struct dsim_device *dsim, unsigned int hs_clk)
+{
+	const struct dsim_pll_params *pll_params = dsim->pll_params;
+	unsigned int i;
+
+	if (!pll_params)
+		return NULL;
+
+	for (i = 0; i < pll_params->num_hs_clks; i++) {
+		if (pll_params->hs_clks[i].hs_clk == hs_clk)
+			return &pll_params->hs_clks[i];
+	}
+
+	return NULL;
+}
+
+/* underrun depends on mode timings, so refresh it for all hs clocks on mode change */
+static void dsim_update_hs_clk_underrun(struct dsim_device *dsim)
+{
+	const struct dsim_pll_params *pll_params = dsim->pll_params;
+	unsigned int i;
+
+	for (i = 0; i < pll_params->num_hs_clks; i++) {
+		struct dsim_hs_clk *c = &pll_params->hs_clks[i];
+		uint32_t underrun_cnt, margin;
+
+		if (__dsim_calc_underrun(&dsim->config, c->hs_clk, &underrun_cnt, &margin)) {
+			underrun_cnt = 0;
+			margin = 0;
+		}
+		c->cmd_underrun_cnt = underrun_cnt;
+		c->margin = margin;
+	}
+}
+
+/* lowest hs clock with enough lp margin for current mode, must be in command mode */
+static const struct dsim_hs_clk *dsim_select_hs_clk(const struct dsim_device *dsim)
+{
+	const struct dsim_pll_params *pll_params = dsim->pll_params;
+	unsigned int i;
+
+	if (dsim->config.mode != DSIM_COMMAND_MODE)
+		return NULL;
+
+	for (i = 0; i < pll_params->num_hs_clks; i++) {
+		const struct dsim_hs_clk *c = &pll_params->hs_clks[i];
+
+		if (c->cmd_underrun_cnt && c->margin >= dsim->hs_clk_min_margin)
+			return c;
+	}
+
+	return NULL;
+}
+
+static void dsim_apply_hs_clk(struct dsim_device *dsim, const struct dsim_hs_clk *c)
+{
+	struct stdphy_pms *pms = &dsim->config.dphy_pms;
+
+	/* keep dithering of the running pll if only m/k change */
+	if (pms->p != c->pms.p || pms->s != c->pms.s)
+		*pms = c->pms;
+	pms->m = c->pms.m;
+	pms->k = c->pms.k;
+
+	dsim->clk_param.hs_clk = c->hs_clk;
+	dsim->config.cmd_underrun_cnt[0] = c->cmd_underrun_cnt;
+	dsim->hs_clk_margin = c->margin;
+
+	dsim_debug(dsim, "hs clock %u selected, lp margin %u%%\n", c->hs_clk, c->margin);
+}
+
 static int dsim_set_clock_mode(struct dsim_device *dsim,
 			       const struct drm_display_mode *mode)
 {
 	struct dsim_pll_param *p = dsim_get_clock_mode(dsim, mode);
+	const struct dsim_hs_clk *c;
+	const struct dsim_hs_clk *running = NULL;
 	uint32_t underrun_cnt;
 
 	if (!p)
 		return -ENOENT;
 
-	if (!dsim_calc_underrun(dsim, p->pll_freq, &underrun_cnt))
+	/* pll keeps running during seamless mode change, so keep its clock */
+	if (dsim->hs_clk_policy == DSIM_HS_CLK_POLICY_MIN_SAFE &&
+	    dsim->state == DSIM_STATE_HSCLKEN)
+		running = dsim_find_hs_clk(dsim, dsim->clk_param.hs_clk);
+
+	dsim_update_hs_clk_underrun(dsim);
+
+	c = dsim_find_hs_clk(dsim, p->pll_freq);
+	if (c && c->cmd_underrun_cnt)
+		p->cmd_underrun_cnt = c->cmd_underrun_cnt;
+	else if (!dsim_calc_underrun(dsim, p->pll_freq, &underrun_cnt))
 		p->cmd_underrun_cnt = underrun_cnt;
 
 	dsim_update_clock_config(dsim, p);
 	dsim->current_pll_param = p;
+	dsim->hs_clk_margin = 0;
+
+	if (dsim->hs_clk_policy != DSIM_HS_CLK_POLICY_MIN_SAFE)
+		return 0;
+
+	if (dsim->state == DSIM_STATE_HSCLKEN) {
+		if (!running)
+			return 0;
+
+		dsim_apply_hs_clk(dsim, running);
+		/* move to the lowest safe clock once the mode switch is done */
+		c = dsim_select_hs_clk(dsim);
+		if (c && c != running)
+			queue_work(system_highpri_wq, &dsim->hs_clk_work);
+		return 0;
+	}
+
+	c = dsim_select_hs_clk(dsim);
+	if (c)
+		dsim_apply_hs_clk(dsim, c);
 
 	return 0;
 }
@@ -728,6 +867,78 @@ read_node_fail:
 	return NULL;
 }
 
+static int dsim_hs_clk_cmp(const void *a, const void *b)
+{
+	const struct dsim_hs_clk *ca = a, *cb = b;
+
+	return (int)ca->hs_clk - (int)cb->hs_clk;
+}
+
+/*
+ * Collect every hs clock used by the dt modes and precompute its pll settings, so that
+ * runtime hs clock changes don't need to calculate pmsk. Pll settings from dt take
+ * precedence over calculated ones.
+ */
+static void dsim_init_hs_clk_table(struct dsim_device *dsim,
+				   struct dsim_pll_params *pll_params)
+{
+	struct dsim_hs_clk *hs_clks;
+	unsigned int i, j, n = 0;
+
+	hs_clks = kcalloc(pll_params->num_modes, sizeof(*hs_clks), GFP_KERNEL);
+	if (!hs_clks)
+		return;
+
+	for (i = 0; i < pll_params->num_modes; i++) {
+		const struct dsim_pll_param *p = pll_params->params[i];
+		struct dsim_hs_clk *c = &hs_clks[n];
+
+		if (!p->pll_freq)
+			continue;
+
+		for (j = 0; j < n; j++) {
+			if (hs_clks[j].hs_clk == p->pll_freq)
+				break;
+		}
+		if (j < n)
+			continue;
+
+		c->hs_clk = p->pll_freq;
+		if (p->p && p->m) {
+			c->pms.p = p->p;
+			c->pms.m = p->m;
+			c->pms.s = p->s;
+			c->pms.k = p->k;
+			c->pms.mfr = p->mfr;
+			c->pms.mrr = p->mrr;
+			c->pms.sel_pf = p->sel_pf;
+			c->pms.icp = p->icp;
+			c->pms.afc_enb = p->afc_enb;
+			c->pms.extafc = p->extafc;
+			c->pms.feed_en = p->feed_en;
+			c->pms.fsel = p->fsel;
+			c->pms.fout_mask = p->fout_mask;
+			c->pms.rsel = p->rsel;
+			c->pms.dither_en = p->dither_en;
+		} else if (!pll_params->features ||
+			   dsim_calc_pmsk(pll_params->features, &c->pms, c->hs_clk)) {
+			dsim_warn(dsim, "no pll settings for hs clock %u\n", c->hs_clk);
+			continue;
+		}
+		n++;
+	}
+
+	sort(hs_clks, n, sizeof(*hs_clks), dsim_hs_clk_cmp, NULL);
+
+	pll_params->hs_clks = hs_clks;
+	pll_params->num_hs_clks = n;
+
+	for (i = 0; i < n; i++)
+		dsim_debug(dsim, "hs clock %u: p(%u) m(%u) s(%u) k(%u)\n", hs_clks[i].hs_clk,
+			   hs_clks[i].pms.p, hs_clks[i].pms.m, hs_clks[i].pms.s,
+			   hs_clks[i].pms.k);
+}
+
 static struct dsim_pll_params *dsim_of_get_clock_mode(struct dsim_device *dsim)
 {
 	struct device *dev = dsim->dev;
@@ -786,6 +997,7 @@ static struct dsim_pll_params *dsim_of_get_clock_mode(struct dsim_device *dsim)
 	}
 
 	pll_params->features = dsim_of_get_pll_features(dsim, np);
+	dsim_init_hs_clk_table(dsim, pll_params);
 
 	of_node_put(np);
 	of_node_put(mode_np);
@@ -1122,6 +1334,22 @@ static bool dsim_mode_is_seamless(const struct dsim_device *dsim,
 		return false;
 	}
 
+	if (dsim->hs_clk_policy == DSIM_HS_CLK_POLICY_MODE && dsim->current_pll_param &&
+	    dsim->clk_param.hs_clk != dsim->current_pll_param->pll_freq) {
+		dsim_debug(dsim, "hs clock change back to mode not allowed seamlessly\n");
+		return false;
+	} else if (dsim->hs_clk_policy == DSIM_HS_CLK_POLICY_MIN_SAFE) {
+		uint32_t underrun, margin;
+
+		/* running hs clock may have been picked for a lighter mode */
+		if (__dsim_calc_underrun(&new_config, dsim->clk_param.hs_clk, &underrun,
+					 &margin) || margin < dsim->hs_clk_min_margin) {
+			dsim_debug(dsim, "hs clock %u too low for mode seamlessly\n",
+				   dsim->clk_param.hs_clk);
+			return false;
+		}
+	}
+
 	if (memcmp(&dsim->config.dsc, &new_config.dsc, sizeof(new_config.dsc))) {
 		dsim_debug(dsim, "dsc change not allowed seamlessly\n");
 		return false;
@@ -1533,6 +1761,7 @@ static irqreturn_t dsim_irq_handler(int irq, void *dev_id)
 	}
 
 	int_src = dsim_reg_get_int_and_clear(dsim->id);
+	int_src |= xchg(&dsim->inject_int_src, 0);
 	if (int_src & DSIM_INTSRC_SFR_PH_FIFO_EMPTY) {
 		complete(&dsim->ph_wr_comp);
 		dsim_debug(dsim, "PH_FIFO_EMPTY irq occurs\n");
@@ -1698,6 +1927,9 @@ static int dsim_host_detach(struct mipi_dsi_host *host,
 
 	dsim_info(dsim, "%s +\n", __func__);
 
+	/* completions of queued commands may still reference the device */
+	kthread_flush_work(&dsim->cmd_work);
+
 	_dsim_disable(dsim);
 	if (dsim->panel_bridge) {
 		struct drm_bridge *bridge = dsim->panel_bridge;
@@ -1815,6 +2047,22 @@ static void __dsim_write_data(struct dsim_device *dsim,
 {
 	struct mipi_dsi_packet packet;
 
+	if (msg->flags & EXYNOS_DSI_MSG_PACKED) {
+		const struct exynos_dsi_packed_msg *pmsg =
+			container_of(msg, struct exynos_dsi_packed_msg, msg);
+		u32 i;
+
+		for (i = 0; i < pmsg->num_words; i++)
+			dsim_reg_wr_tx_payload(dsim->id, pmsg->payload[i]);
+		dsim_reg_wr_tx_header(dsim->id, pmsg->header[0], pmsg->header[1],
+				      pmsg->header[2], false);
+
+		dsim_debug(dsim, "packed header(0x%x 0x%x 0x%x) words(%u) ph fifo(%d)\n",
+			   pmsg->header[0], pmsg->header[1], pmsg->header[2],
+			   pmsg->num_words, dsim_reg_get_ph_cnt(dsim->id));
+		return;
+	}
+
 	mipi_dsi_create_packet(&packet, msg);
 
 	if (is_long)
@@ -1827,6 +2075,34 @@ static void __dsim_write_data(struct dsim_device *dsim,
 			packet.size, dsim_reg_get_ph_cnt(dsim->id));
 }
 
+/* returns traffic bucket of current frame, closing the previous one on a new vsync */
+static struct dsim_traffic_frame *dsim_traffic_frame(struct dsim_device *dsim)
+{
+	const struct decon_device *decon = dsim_get_decon(dsim);
+	struct dsim_traffic *t = &dsim->traffic;
+	/*
+	 * vblank irq is off while idle or in hibernation, accurate count keeps
+	 * advancing from timestamps so that idle commands still get their own frame
+	 */
+	const u64 count = (decon && decon->crtc) ?
+		drm_crtc_accurate_vblank_count(&decon->crtc->base) : 0;
+
+	if (count == t->vblank_count)
+		return &t->cur;
+
+	/* only frames which carried commands are kept, idle frames tell nothing */
+	if (t->cur.packets || t->cur.vblank_waits) {
+		t->frames[t->head] = t->cur;
+		t->head = (t->head + 1) % DSIM_TRAFFIC_WINDOW;
+		if (t->num_frames < DSIM_TRAFFIC_WINDOW)
+			t->num_frames++;
+	}
+	memset(&t->cur, 0, sizeof(t->cur));
+	t->vblank_count = count;
+
+	return &t->cur;
+}
+
 static int dsim_write_single_cmd_locked(struct dsim_device *dsim,
 				const struct mipi_dsi_msg *msg, bool is_long)
 {
@@ -1864,13 +2140,37 @@ static int dsim_write_single_cmd_locked(struct dsim_device *dsim,
  * at once.
  */
 #define PKTGO_READY_MARGIN_NS	1000000
-static void need_wait_vblank(struct dsim_device *dsim)
+
+/* slack after the predicted TE so that the vblank timestamp has been updated */
+#define PKTGO_TE_SETTLE_NS	100000
+#define PKTGO_TIMER_SLACK_NS	50000
+
+/*
+ * Sleep until the next TE, predicted from the last vblank timestamp, instead of waiting
+ * for the vblank event. Returns false if the TE didn't show up as predicted.
+ */
+static bool dsim_pktgo_sleep_until_te(struct drm_crtc *crtc, u64 last_count,
+				      ktime_t last_vblanktime, u32 framedur_ns)
+{
+	ktime_t expires = ktime_add_ns(last_vblanktime, framedur_ns + PKTGO_TE_SETTLE_NS);
+	ktime_t vblanktime;
+
+	set_current_state(TASK_UNINTERRUPTIBLE);
+	schedule_hrtimeout_range(&expires, PKTGO_TIMER_SLACK_NS, HRTIMER_MODE_ABS);
+
+	return drm_crtc_vblank_count_and_time(crtc, &vblanktime) != last_count;
+}
+
+static void dsim_pktgo_wait_window(struct dsim_device *dsim,
+				   struct dsim_traffic_frame *frame)
 {
 	const struct decon_device *decon = dsim_get_decon(dsim);
 	struct drm_vblank_crtc *vblank;
 	struct drm_crtc *crtc;
-	ktime_t last_vblanktime, diff, cur_time;
-	int ready_allow_period;
+	ktime_t last_vblanktime, cur_time;
+	s64 diff, ready_allow_period;
+	u64 count;
+	u32 framedur_ns;
 
 	if (!decon)
 		return;
@@ -1883,26 +2183,46 @@ static void need_wait_vblank(struct dsim_device *dsim)
 		return;
 
 	vblank = &crtc->dev->vblank[crtc->index];
+	framedur_ns = vblank->framedur_ns;
 	ready_allow_period =
-		mult_frac(vblank->framedur_ns, 95, 100) - PKTGO_READY_MARGIN_NS;
+		mult_frac(framedur_ns, 95, 100) - PKTGO_READY_MARGIN_NS;
 
-	drm_crtc_vblank_count_and_time(crtc, &last_vblanktime);
+	count = drm_crtc_vblank_count_and_time(crtc, &last_vblanktime);
 	cur_time = ktime_get();
-	diff = ktime_sub_ns(cur_time, last_vblanktime);
+	diff = ktime_to_ns(ktime_sub(cur_time, last_vblanktime));
 
-	dsim_debug(dsim, "last(%lld) cur(%lld) diff(%lld) ready allow period(%d)\n",
+	dsim_debug(dsim, "last(%lld) cur(%lld) diff(%lld) ready allow period(%lld)\n",
 			last_vblanktime, cur_time, diff, ready_allow_period);
 
-	if (diff > ready_allow_period) {
-		DPU_ATRACE_BEGIN("dsim_pktgo_wait_vblank");
+	if (diff <= ready_allow_period) {
+		dsim->pktgo_stats.in_window++;
+		goto out;
+	}
+
+	frame->vblank_waits++;
+	DPU_ATRACE_BEGIN("dsim_pktgo_wait_vblank");
+	if (framedur_ns && diff < framedur_ns) {
+		/* next window opens at the next TE, which is less than a frame away */
+		dsim->pktgo_stats.deferred++;
+		if (!dsim_pktgo_sleep_until_te(crtc, count, last_vblanktime, framedur_ns)) {
+			dsim->pktgo_stats.late_te++;
+			drm_crtc_wait_one_vblank(crtc);
+		}
+	} else {
+		/* vblank timestamp is stale, TE phase is unknown */
+		dsim->pktgo_stats.stale++;
 		drm_crtc_wait_one_vblank(crtc);
-		DPU_ATRACE_END("dsim_pktgo_wait_vblank");
 	}
+	DPU_ATRACE_END("dsim_pktgo_wait_vblank");
+
+	diff = ktime_us_delta(ktime_get(), cur_time);
+	dsim->pktgo_stats.total_wait_us += diff;
+	if (diff > dsim->pktgo_stats.max_wait_us)
+		dsim->pktgo_stats.max_wait_us = diff;
+out:
 	drm_crtc_vblank_put(crtc);
 }
 
-#define PL_FIFO_THRESHOLD	mult_frac(MAX_PL_FIFO, 75, 100) /* 75% */
-#define IS_LAST(flags)		(((flags) & MIPI_DSI_MSG_LASTCOMMAND) != 0)
 static int
 dsim_write_data(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
 {
@@ -1911,6 +2231,10 @@ dsim_write_data(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
 	bool is_long;
 	bool is_empty_msg;
 	bool is_last;
+	bool fifo_full;
+	const ktime_t start = ktime_get();
+	/* sampled once, so a batch released after a vblank wait stays in its frame */
+	struct dsim_traffic_frame *frame = dsim_traffic_frame(dsim);
 
 	DPU_ATRACE_BEGIN(__func__);
 
@@ -1940,19 +2264,18 @@ dsim_write_data(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
 		goto err;
 	}
 
-	is_last = (IS_LAST(flags) && !dsim->force_batching) || (flags & EXYNOS_DSI_MSG_FORCE_FLUSH);
+	is_last = dsim_cmd_is_last(msg, dsim->force_batching, dsim->total_pend_ph,
+				   dsim->total_pend_pl, &fifo_full);
 
 	if (flags & EXYNOS_DSI_MSG_FORCE_FLUSH) {
 		dsim->force_batching = false;
 		WARN_ON(!is_empty_msg);
 	}
 
-	if (!is_last && !is_empty_msg &&
-		(((dsim->total_pend_ph + 1) == MAX_PH_FIFO) ||
-		((dsim->total_pend_pl + msg->tx_len) > PL_FIFO_THRESHOLD))) {
+	if (fifo_full) {
 		dsim_warn(dsim, "warning. changed last command. pend pl/pl(%u,%u)\n",
 				dsim->total_pend_ph, dsim->total_pend_pl);
-		is_last = true;
+		frame->forced_last++;
 	}
 
 	trace_dsi_tx(msg->type, msg->tx_buf, msg->tx_len, is_last);
@@ -1967,7 +2290,7 @@ dsim_write_data(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
 				__dsim_write_data(dsim, msg, is_long);
 
 			if (!(flags & EXYNOS_DSI_MSG_IGNORE_VBLANK))
-				need_wait_vblank(dsim);
+				dsim_pktgo_wait_window(dsim, frame);
 
 			dsim_reg_ready_packetgo(dsim->id, true);
 			dsim_debug(dsim, "packet go ready\n");
@@ -1996,23 +2319,32 @@ dsim_write_data(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
 	}
 
 err:
+	if (!is_empty_msg && !ret) {
+		frame->packets++;
+		frame->bytes += msg->tx_len;
+	}
+	frame->block_us += ktime_us_delta(ktime_get(), start);
+
 	trace_dsi_cmd_fifo_status(dsim->total_pend_ph, dsim->total_pend_pl);
 	DPU_ATRACE_END(__func__);
 	return ret;
 }
 
 static int
-dsim_req_read_command(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
+dsim_req_read_command(struct dsim_device *dsim, const struct mipi_dsi_msg *msg,
+		      bool set_max_size)
 {
 	struct mipi_dsi_packet packet;
 	const u8 rx_len = msg->rx_len & 0xff;
 
 	dsim_reg_clear_int(dsim->id, DSIM_INTSRC_SFR_PH_FIFO_EMPTY);
 	reinit_completion(&dsim->ph_wr_comp);
-	trace_dsi_tx(MIPI_DSI_SET_MAXIMUM_RETURN_PACKET_SIZE, &rx_len, 1, true);
-	/* set the maximum packet size returned */
-	dsim_reg_wr_tx_header(dsim->id, MIPI_DSI_SET_MAXIMUM_RETURN_PACKET_SIZE,
-			msg->rx_len, 0, false);
+	if (set_max_size) {
+		trace_dsi_tx(MIPI_DSI_SET_MAXIMUM_RETURN_PACKET_SIZE, &rx_len, 1, true);
+		/* set the maximum packet size returned */
+		dsim_reg_wr_tx_header(dsim->id, MIPI_DSI_SET_MAXIMUM_RETURN_PACKET_SIZE,
+				msg->rx_len, 0, false);
+	}
 
 	/* read request */
 	mipi_dsi_create_packet(&packet, msg);
@@ -2024,7 +2356,8 @@ dsim_req_read_command(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
 }
 
 static int
-dsim_read_data(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
+dsim_read_data(struct dsim_device *dsim, const struct mipi_dsi_msg *msg,
+	       bool set_max_size)
 {
 	u32 rx_fifo, rx_size = 0;
 	int i = 0, ret = 0;
@@ -2042,7 +2375,7 @@ dsim_read_data(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
 
 	reinit_completion(&dsim->rd_comp);
 
-	ret = dsim_req_read_command(dsim, msg);
+	ret = dsim_req_read_command(dsim, msg, set_max_size);
 	if (ret) {
 		dsim_err(dsim, "failed to request dsi read command\n");
 		return ret;
@@ -2118,6 +2451,40 @@ dsim_read_data(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
 	return rx_size;
 }
 
+static int
+dsim_read_batch(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
+{
+	const struct exynos_dsi_read_batch *batch =
+		container_of(msg, struct exynos_dsi_read_batch, msg);
+	size_t max_rx_len = 0;
+	int i, ret;
+
+	for (i = 0; i < batch->num_reads; i++) {
+		struct exynos_dsi_read *r = &batch->reads[i];
+		const struct mipi_dsi_msg rmsg = {
+			.channel = msg->channel,
+			.type = MIPI_DSI_DCS_READ,
+			.flags = msg->flags & ~EXYNOS_DSI_MSG_READ_BATCH,
+			.tx_buf = &r->reg,
+			.tx_len = 1,
+			.rx_buf = r->rx_buf,
+			.rx_len = r->rx_len,
+		};
+
+		/* panel keeps the maximum return packet size until it's changed */
+		r->ret = dsim_read_data(dsim, &rmsg, r->rx_len != max_rx_len);
+		if (r->ret < 0) {
+			ret = r->ret;
+			dsim_err(dsim, "batch read %d/%u (0x%x) failed (%d)\n",
+				 i + 1, batch->num_reads, r->reg, ret);
+			return i ? i : ret;
+		}
+		max_rx_len = r->rx_len;
+	}
+
+	return i;
+}
+
 static int
 dsim_write_data_dual(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
 {
@@ -2140,10 +2507,9 @@ dsim_write_data_dual(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
 
 	return ret;
 }
-static ssize_t dsim_host_transfer(struct mipi_dsi_host *host,
+static ssize_t __dsim_host_transfer(struct dsim_device *dsim,
 			    const struct mipi_dsi_msg *msg)
 {
-	struct dsim_device *dsim = host_to_dsi(host);
 	struct dsim_device *sec_dsi;
 	int ret;
 
@@ -2166,7 +2532,10 @@ static ssize_t dsim_host_transfer(struct mipi_dsi_host *host,
 	case MIPI_DSI_GENERIC_READ_REQUEST_0_PARAM:
 	case MIPI_DSI_GENERIC_READ_REQUEST_1_PARAM:
 	case MIPI_DSI_GENERIC_READ_REQUEST_2_PARAM:
-		ret = dsim_read_data(dsim, msg);
+		if (msg->flags & EXYNOS_DSI_MSG_READ_BATCH)
+			ret = dsim_read_batch(dsim, msg);
+		else
+			ret = dsim_read_data(dsim, msg, true);
 		break;
 	default:
 		ret = dsim_write_data(dsim, msg);
@@ -2191,6 +2560,116 @@ abort:
 	return ret;
 }
 
+struct dsim_async_cmd {
+	struct list_head node;
+	struct mipi_dsi_msg msg;
+	void (*complete)(void *data, int ret);
+	void *data;
+	u8 tx_buf[];
+};
+
+static int dsim_queue_async_cmd(struct dsim_device *dsim, const struct mipi_dsi_msg *msg)
+{
+	const struct exynos_dsi_async_msg *amsg =
+		container_of(msg, struct exynos_dsi_async_msg, msg);
+	struct dsim_async_cmd *cmd;
+	unsigned long flags;
+
+	switch (msg->type) {
+	case MIPI_DSI_DCS_READ:
+	case MIPI_DSI_GENERIC_READ_REQUEST_0_PARAM:
+	case MIPI_DSI_GENERIC_READ_REQUEST_1_PARAM:
+	case MIPI_DSI_GENERIC_READ_REQUEST_2_PARAM:
+		dsim_err(dsim, "read commands can't be queued\n");
+		return -EINVAL;
+	default:
+		break;
+	}
+
+	cmd = kmalloc(struct_size(cmd, tx_buf, msg->tx_len), GFP_KERNEL);
+	if (!cmd)
+		return -ENOMEM;
+
+	/* tx_buf is copied, so packed fifo words of the caller can't be used */
+	cmd->msg = *msg;
+	cmd->msg.flags &= ~(EXYNOS_DSI_MSG_ASYNC | EXYNOS_DSI_MSG_PACKED);
+	cmd->msg.tx_buf = msg->tx_len ? cmd->tx_buf : NULL;
+	if (msg->tx_len)
+		memcpy(cmd->tx_buf, msg->tx_buf, msg->tx_len);
+	cmd->complete = amsg->complete;
+	cmd->data = amsg->data;
+
+	spin_lock_irqsave(&dsim->cmd_queue_lock, flags);
+	if (dsim->cmd_queue_depth >= DSIM_CMD_QUEUE_MAX_DEPTH) {
+		dsim->cmd_queue_stats.rejected++;
+		spin_unlock_irqrestore(&dsim->cmd_queue_lock, flags);
+		kfree(cmd);
+		dsim_warn(dsim, "command queue is full(%d)\n", DSIM_CMD_QUEUE_MAX_DEPTH);
+		return -EBUSY;
+	}
+	list_add_tail(&cmd->node, &dsim->cmd_queue);
+	dsim->cmd_queue_depth++;
+	dsim->cmd_queue_stats.queued++;
+	dsim->cmd_queue_stats.max_depth = max(dsim->cmd_queue_stats.max_depth,
+					      dsim->cmd_queue_depth);
+	spin_unlock_irqrestore(&dsim->cmd_queue_lock, flags);
+
+	kthread_queue_work(&dsim->cmd_worker, &dsim->cmd_work);
+
+	return 0;
+}
+
+static void dsim_cmd_work(struct kthread_work *work)
+{
+	struct dsim_device *dsim = container_of(work, struct dsim_device, cmd_work);
+	struct dsim_async_cmd *cmd;
+	unsigned long flags;
+	ssize_t ret;
+
+	DPU_ATRACE_BEGIN(__func__);
+
+	for (;;) {
+		spin_lock_irqsave(&dsim->cmd_queue_lock, flags);
+		cmd = list_first_entry_or_null(&dsim->cmd_queue, struct dsim_async_cmd, node);
+		if (cmd) {
+			list_del(&cmd->node);
+			dsim->cmd_queue_depth--;
+		}
+		spin_unlock_irqrestore(&dsim->cmd_queue_lock, flags);
+
+		if (!cmd)
+			break;
+
+		ret = __dsim_host_transfer(dsim, &cmd->msg);
+		if (ret < 0)
+			dsim->cmd_queue_stats.failed++;
+
+		if (cmd->complete)
+			cmd->complete(cmd->data, ret < 0 ? ret : 0);
+		kfree(cmd);
+	}
+
+	DPU_ATRACE_END(__func__);
+}
+
+static ssize_t dsim_host_transfer(struct mipi_dsi_host *host,
+			    const struct mipi_dsi_msg *msg)
+{
+	struct dsim_device *dsim = host_to_dsi(host);
+
+	if (msg->flags & EXYNOS_DSI_MSG_ASYNC)
+		return dsim_queue_async_cmd(dsim, msg);
+
+	/*
+	 * Commands queued earlier must reach the panel first. Completion callbacks run on
+	 * cmd_thread and may send synchronously without waiting on themselves.
+	 */
+	if (current != dsim->cmd_thread)
+		kthread_flush_work(&dsim->cmd_work);
+
+	return __dsim_host_transfer(dsim, msg);
+}
+
 /* TODO: Below operation will be registered after panel driver is created. */
 static const struct mipi_dsi_host_ops dsim_host_ops = {
 	.attach = dsim_host_attach,
@@ -2264,10 +2743,13 @@ static int dsim_calc_pmsk(struct dsim_pll_features *pll_features,
 	return 0;
 }
 
-static int dsim_calc_underrun(const struct dsim_device *dsim, uint32_t hs_clock_mhz,
-		uint32_t *underrun)
+/*
+ * @margin (optional) returns the part of max frame time left for lp after transferring
+ * the frame at @hs_clock_mhz, in percent.
+ */
+static int __dsim_calc_underrun(const struct dsim_reg_config *config, uint32_t hs_clock_mhz,
+		uint32_t *underrun, uint32_t *margin)
 {
-	const struct dsim_reg_config *config = &dsim->config;
 	uint32_t lanes = config->data_lane_cnt;
 	uint32_t number_of_transfer;
 	uint32_t w_threshold;
@@ -2297,7 +2779,7 @@ static int dsim_calc_underrun(const struct dsim_device *dsim, uint32_t hs_clock_
 					NSEC_PER_SEC / (2 * lanes * wclk);
 
 	if (max_frame_time < min_frame_transfer_time) {
-		pr_err("%s: max frame time %llu < min frame time %llu\n",
+		pr_debug("%s: max frame time %llu < min frame time %llu\n",
 			__func__, max_frame_time, min_frame_transfer_time);
 		return -EINVAL;
 	}
@@ -2305,32 +2787,119 @@ static int dsim_calc_underrun(const struct dsim_device *dsim, uint32_t hs_clock_
 	max_lp_time = max_frame_time - min_frame_transfer_time;
 	/* underrun unit is 100 wclk, round up */
 	*underrun = (uint32_t) DIV_ROUND_UP(max_lp_time * wclk / NSEC_PER_SEC, 100);
+	if (margin)
+		*margin = (uint32_t) div64_u64(max_lp_time * 100, max_frame_time);
 
 	return 0;
 }
 
+static int dsim_calc_underrun(const struct dsim_device *dsim, uint32_t hs_clock_mhz,
+		uint32_t *underrun)
+{
+	return __dsim_calc_underrun(&dsim->config, hs_clock_mhz, underrun, NULL);
+}
+
+/*
+ * Switch pll without stopping dsim. Only M and K can go through the dphy shadow registers,
+ * which are latched at frame start, so P and S must stay the same. Dithering settings
+ * aren't touched. D-PHY timing, escape clock prescaler and hsmode aren't reprogrammed
+ * either, so both clocks must also share them.
+ */
+static bool dsim_hs_clock_is_seamless(const struct dsim_device *dsim, uint32_t hs_clk,
+				      const struct stdphy_pms *pms)
+{
+	const struct stdphy_pms *cur = &dsim->config.dphy_pms;
+
+	return dsim->config.mode == DSIM_COMMAND_MODE &&
+		cur->p == pms->p && cur->s == pms->s && dsim->current_pll_param &&
+		dsim_reg_is_dphy_timing_shared(dsim->id, dsim->clk_param.hs_clk, hs_clk,
+					       dsim->current_pll_param->esc_freq);
+}
+
+static void dsim_switch_hs_clock_seamless(struct dsim_device *dsim, uint32_t old_underrun)
+{
+	const struct decon_device *decon = dsim_get_decon(dsim);
+	const struct stdphy_pms *pms = &dsim->config.dphy_pms;
+	/* larger lp ref first so that underrun isn't flagged while clocks are mixed */
+	const bool underrun_first = dsim->config.cmd_underrun_cnt[0] > old_underrun;
+
+	DPU_ATRACE_BEGIN(__func__);
+
+	mutex_lock(&dsim->cmd_lock);
+	if (underrun_first)
+		dsim_reg_set_vrr_config(dsim->id, &dsim->config, &dsim->clk_param);
+	dsim_reg_set_dphy_freq_hopping(dsim->id, pms->p, pms->m, pms->k, true);
+	mutex_unlock(&dsim->cmd_lock);
+
+	if (decon && decon->crtc)
+		drm_crtc_wait_one_vblank(&decon->crtc->base);
+
+	mutex_lock(&dsim->cmd_lock);
+	dsim_reg_set_dphy_freq_hopping(dsim->id, 0, 0, 0, false);
+	if (!underrun_first)
+		dsim_reg_set_vrr_config(dsim->id, &dsim->config, &dsim->clk_param);
+	mutex_unlock(&dsim->cmd_lock);
+
+	DPU_ATRACE_END(__func__);
+}
+
+static void dsim_hs_clk_work(struct work_struct *work)
+{
+	struct dsim_device *dsim = container_of(work, struct dsim_device, hs_clk_work);
+	const struct dsim_hs_clk *c;
+	uint32_t old_underrun;
+
+	mutex_lock(&dsim->state_lock);
+	if (dsim->state != DSIM_STATE_HSCLKEN ||
+	    dsim->hs_clk_policy != DSIM_HS_CLK_POLICY_MIN_SAFE)
+		goto out;
+
+	c = dsim_select_hs_clk(dsim);
+	if (!c || c->hs_clk == dsim->clk_param.hs_clk)
+		goto out;
+
+	if (!dsim_hs_clock_is_seamless(dsim, c->hs_clk, &c->pms)) {
+		dsim_debug(dsim, "hs clock %u deferred to next enable\n", c->hs_clk);
+		goto out;
+	}
+
+	old_underrun = dsim->config.cmd_underrun_cnt[0];
+	dsim_apply_hs_clk(dsim, c);
+	dsim_switch_hs_clock_seamless(dsim, old_underrun);
+	dsim_info(dsim, "hs clock switched to %u, lp margin %u%%\n", c->hs_clk, c->margin);
+out:
+	mutex_unlock(&dsim->state_lock);
+}
+
 static int dsim_set_hs_clock(struct dsim_device *dsim, unsigned int hs_clock, bool apply_now)
 {
-	int ret;
+	int ret = 0;
 	struct stdphy_pms pms;
-	uint32_t lp_underrun = 0;
+	uint32_t lp_underrun = 0, old_underrun;
 	struct dsim_pll_param *pll_param;
+	const struct dsim_hs_clk *c;
 
 	if (!dsim->pll_params || !dsim->pll_params->features)
 		return -ENODEV;
 
 	memset(&pms, 0, sizeof(pms));
-	ret = dsim_calc_pmsk(dsim->pll_params->features, &pms, hs_clock);
-	if (ret < 0) {
+	c = dsim_find_hs_clk(dsim, hs_clock);
+	if (c) {
+		pms = c->pms;
+	} else if (dsim_calc_pmsk(dsim->pll_params->features, &pms, hs_clock) < 0) {
 		dsim_err(dsim, "Failed to update pll for hsclk %d\n", hs_clock);
 		return -EINVAL;
 	}
 
 	mutex_lock(&dsim->state_lock);
-	ret = dsim_calc_underrun(dsim, hs_clock, &lp_underrun);
-	if (ret < 0) {
-		dsim_err(dsim, "Failed to update underrun\n");
-		goto out;
+	if (c && c->cmd_underrun_cnt) {
+		lp_underrun = c->cmd_underrun_cnt;
+	} else {
+		ret = dsim_calc_underrun(dsim, hs_clock, &lp_underrun);
+		if (ret < 0) {
+			dsim_err(dsim, "Failed to update underrun\n");
+			goto out;
+		}
 	}
 
 	pll_param = dsim->current_pll_param;
@@ -2339,6 +2908,37 @@ static int dsim_set_hs_clock(struct dsim_device *dsim, unsigned int hs_clock, bo
 		goto out;
 	}
 
+	if (pll_param->pll_freq == hs_clock)
+		goto out;
+
+	/* p, s and dithering of the current mode are kept if the switch is seamless */
+	if (!dsim_hs_clock_is_seamless(dsim, hs_clock, &pms) && c) {
+		pll_param->mfr = pms.mfr;
+		pll_param->mrr = pms.mrr;
+		pll_param->sel_pf = pms.sel_pf;
+		pll_param->icp = pms.icp;
+		pll_param->afc_enb = pms.afc_enb;
+		pll_param->extafc = pms.extafc;
+		pll_param->feed_en = pms.feed_en;
+		pll_param->fsel = pms.fsel;
+		pll_param->fout_mask = pms.fout_mask;
+		pll_param->rsel = pms.rsel;
+		pll_param->dither_en = pms.dither_en;
+	}
+
+	old_underrun = dsim->config.cmd_underrun_cnt[0];
+	apply_now = apply_now && dsim->state == DSIM_STATE_HSCLKEN;
+	if (apply_now && dsim_hs_clock_is_seamless(dsim, hs_clock, &pms)) {
+		pll_param->pll_freq = hs_clock;
+		pll_param->m = pms.m;
+		pll_param->k = pms.k;
+		pll_param->cmd_underrun_cnt = lp_underrun;
+		dsim_update_clock_config(dsim, pll_param);
+		dsim_switch_hs_clock_seamless(dsim, old_underrun);
+		dsim_info(dsim, "hs clock switched to %u seamlessly\n", hs_clock);
+		goto out;
+	}
+
 	pll_param->pll_freq = hs_clock;
 	pll_param->p = pms.p;
 	pll_param->m = pms.m;
@@ -2347,7 +2947,7 @@ static int dsim_set_hs_clock(struct dsim_device *dsim, unsigned int hs_clock, bo
 	pll_param->cmd_underrun_cnt = lp_underrun;
 	dsim_update_clock_config(dsim, pll_param);
 
-	if (!apply_now || dsim->state != DSIM_STATE_HSCLKEN)
+	if (!apply_now)
 		goto out;
 
 	/* Restart dsim to apply new clock settings */
@@ -2455,6 +3055,61 @@ static ssize_t hs_clock_store(struct device *dev,
 }
 static DEVICE_ATTR_RW(hs_clock);
 
+static ssize_t hs_clock_policy_show(struct device *dev,
+				    struct device_attribute *attr,
+				    char *buf)
+{
+	struct dsim_device *dsim = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "%s margin %u%% (min %u%%)\n",
+			dsim->hs_clk_policy == DSIM_HS_CLK_POLICY_MIN_SAFE ?
+			"min_safe" : "mode", dsim->hs_clk_margin, dsim->hs_clk_min_margin);
+}
+
+/* "mode" or "min_safe [min margin percent]", takes effect from next mode set */
+static ssize_t hs_clock_policy_store(struct device *dev,
+				     struct device_attribute *attr,
+				     const char *buf, size_t len)
+{
+	struct dsim_device *dsim = dev_get_drvdata(dev);
+	enum dsim_hs_clk_policy policy;
+	unsigned int min_margin = dsim->hs_clk_min_margin;
+	char params[32];
+	char *policy_str;
+	char *margin_str;
+	char *p = params;
+	int rc;
+
+	strlcpy(params, buf, sizeof(params));
+	policy_str = strim(strsep(&p, " "));
+	margin_str = strsep(&p, " ");
+
+	if (!strcmp(policy_str, "mode"))
+		policy = DSIM_HS_CLK_POLICY_MODE;
+	else if (!strcmp(policy_str, "min_safe"))
+		policy = DSIM_HS_CLK_POLICY_MIN_SAFE;
+	else
+		return -EINVAL;
+
+	if (margin_str) {
+		rc = kstrtouint(strim(margin_str), 0, &min_margin);
+		if (rc < 0)
+			return rc;
+		if (min_margin >= 100)
+			return -EINVAL;
+	}
+
+	mutex_lock(&dsim->state_lock);
+	dsim->hs_clk_policy = policy;
+	dsim->hs_clk_min_margin = min_margin;
+	mutex_unlock(&dsim->state_lock);
+
+	dsim_info(dsim, "hs clock policy %s, min margin %u%%\n", policy_str, min_margin);
+
+	return len;
+}
+static DEVICE_ATTR_RW(hs_clock_policy);
+
 static int dsim_get_pinctrl(struct dsim_device *dsim)
 {
 	int ret = 0;
@@ -2490,6 +3145,9 @@ err:
 static int dsim_probe(struct platform_device *pdev)
 {
 	struct dsim_device *dsim;
+	struct sched_param param = {
+		.sched_priority = 20
+	};
 	int ret;
 
 	dsim = devm_kzalloc(&pdev->dev, sizeof(*dsim), GFP_KERNEL);
@@ -2517,14 +3175,30 @@ static int dsim_probe(struct platform_device *pdev)
 	init_completion(&dsim->ph_wr_comp);
 	init_completion(&dsim->pl_wr_comp);
 	init_completion(&dsim->rd_comp);
+	INIT_WORK(&dsim->ulps_exit_work, dsim_ulps_exit_work);
+	INIT_WORK(&dsim->hs_clk_work, dsim_hs_clk_work);
+	dsim->hs_clk_min_margin = DSIM_HS_CLK_DEFAULT_MIN_MARGIN;
+
+	spin_lock_init(&dsim->cmd_queue_lock);
+	INIT_LIST_HEAD(&dsim->cmd_queue);
+	kthread_init_work(&dsim->cmd_work, dsim_cmd_work);
+	kthread_init_worker(&dsim->cmd_worker);
+	dsim->cmd_thread = kthread_run(kthread_worker_fn, &dsim->cmd_worker,
+				       "dsim%d_cmd", dsim->id);
+	if (IS_ERR(dsim->cmd_thread)) {
+		dsim_err(dsim, "failed to run command thread\n");
+		ret = PTR_ERR(dsim->cmd_thread);
+		goto err;
+	}
+	sched_setscheduler_nocheck(dsim->cmd_thread, SCHED_FIFO, &param);
 
 	ret = dsim_init_resources(dsim);
 	if (ret)
-		goto err;
+		goto err_thread;
 
 	ret = dsim_get_pinctrl(dsim);
 	if (ret)
-		goto err;
+		goto err_thread;
 
 	ret = device_create_file(dsim->dev, &dev_attr_bist_mode);
 	if (ret < 0)
@@ -2534,6 +3208,10 @@ static int dsim_probe(struct platform_device *pdev)
 	if (ret < 0)
 		dsim_err(dsim, "failed to add sysfs hs_clock entries\n");
 
+	ret = device_create_file(dsim->dev, &dev_attr_hs_clock_policy);
+	if (ret < 0)
+		dsim_err(dsim, "failed to add sysfs hs_clock_policy entries\n");
+
 	platform_set_drvdata(pdev, &dsim->encoder);
 
 #if defined(CONFIG_CPU_IDLE)
@@ -2560,9 +3238,17 @@ static int dsim_probe(struct platform_device *pdev)
 			phy_init(dsim->res.phy_ex);
 	}
 
+	ret = component_add(dsim->dev, &dsim_component_ops);
+	if (ret)
+		goto err_pm;
+
 	dsim_info(dsim, "driver has been probed.\n");
-	return component_add(dsim->dev, &dsim_component_ops);
+	return 0;
 
+err_pm:
+	pm_runtime_disable(dsim->dev);
+err_thread:
+	kthread_stop(dsim->cmd_thread);
 err:
 	dsim_err(dsim, "failed to probe exynos dsim driver\n");
 	return ret;
@@ -2574,7 +3260,12 @@ static int dsim_remove(struct platform_device *pdev)
 
 	device_remove_file(dsim->dev, &dev_attr_bist_mode);
 	device_remove_file(dsim->dev, &dev_attr_hs_clock);
+	device_remove_file(dsim->dev, &dev_attr_hs_clock_policy);
+	cancel_work_sync(&dsim->hs_clk_work);
+	kthread_flush_worker(&dsim->cmd_worker);
+	kthread_stop(dsim->cmd_thread);
 	pm_runtime_disable(&pdev->dev);
+	cancel_work_sync(&dsim->ulps_exit_work);
 
 	component_del(&pdev->dev, &dsim_component_ops);
 
@@ -21,6 +21,8 @@
 #include <drm/drm_property.h>
 #include <drm/drm_panel.h>
 #include <video/videomode.h>
+#include <linux/kthread.h>
+#include <linux/workqueue.h>
 
 #include <dsim_cal.h>
 
@@ -51,10 +53,30 @@ struct dsim_pll_features {
 	u32 k_bits;
 };
 
+/* precomputed pll settings of a supported hs clock */
+struct dsim_hs_clk {
+	unsigned int hs_clk; /* Mhz */
+	struct stdphy_pms pms;
+	/* underrun lp ref for current mode, 0 if clock can't sustain it */
+	unsigned int cmd_underrun_cnt;
+	/* percent of max frame time left for lp in current mode */
+	unsigned int margin;
+};
+
+enum dsim_hs_clk_policy {
+	DSIM_HS_CLK_POLICY_MODE,	/* hs clock of the dt mode */
+	DSIM_HS_CLK_POLICY_MIN_SAFE,	/* lowest hs clock underrun model allows */
+};
+
+#define DSIM_HS_CLK_DEFAULT_MIN_MARGIN	10
+
 struct dsim_pll_params {
 	unsigned int num_modes;
 	struct dsim_pll_param **params;
 	struct dsim_pll_features *features;
+	/* distinct hs clocks of all modes, sorted in ascending order */
+	unsigned int num_hs_clks;
+	struct dsim_hs_clk *hs_clks;
 };
 
 struct dsim_resources {
@@ -66,6 +88,28 @@ struct dsim_resources {
 	struct phy *phy_ex;
 };
 
+/* command traffic pushed to panel within one vsync */
+struct dsim_traffic_frame {
+	u32 packets;
+	u32 bytes;
+	/* batch released early because fifo was about to fill up */
+	u32 forced_last;
+	u32 vblank_waits;
+	/* time spent by callers inside dsim write path */
+	u32 block_us;
+};
+
+#define DSIM_TRAFFIC_WINDOW	64
+
+/* per vsync traffic of the last DSIM_TRAFFIC_WINDOW frames with commands */
+struct dsim_traffic {
+	u64 vblank_count;
+	struct dsim_traffic_frame cur;
+	struct dsim_traffic_frame frames[DSIM_TRAFFIC_WINDOW];
+	u32 head;
+	u32 num_frames;
+};
+
 struct dsim_device {
 	struct drm_encoder encoder;
 	struct mipi_dsi_host dsi_host;
@@ -118,8 +162,51 @@ struct dsim_device {
 	bool force_batching;
 
 	enum dsim_dual_dsi dual_dsi;
+
+	/* exits ULPS in parallel with DECON while coming out of hibernation */
+	struct work_struct ulps_exit_work;
+
+	enum dsim_hs_clk_policy hs_clk_policy;
+	/* min lp margin in percent for DSIM_HS_CLK_POLICY_MIN_SAFE */
+	u32 hs_clk_min_margin;
+	/* lp margin of the selected hs clock, 0 if not selected by policy */
+	u32 hs_clk_margin;
+	/* moves to the selected hs clock after a seamless mode change */
+	struct work_struct hs_clk_work;
+
+	/* fault injection: interrupt sources reported along with next irq */
+	u32 inject_int_src;
+
+	/* async command queue, drained in order by cmd_worker */
+	struct kthread_worker cmd_worker;
+	struct task_struct *cmd_thread;
+	struct kthread_work cmd_work;
+	spinlock_t cmd_queue_lock;
+	struct list_head cmd_queue;
+	u32 cmd_queue_depth;
+	struct {
+		u64 queued;
+		u64 rejected;
+		u64 failed;
+		u32 max_depth;
+	} cmd_queue_stats;
+
+	/* protected by cmd_lock */
+	struct dsim_traffic traffic;
+
+	/* packet-go window scheduling, see dsim_pktgo_wait_window() */
+	struct {
+		u64 in_window;
+		u64 deferred;
+		u64 late_te;
+		u64 stale;
+		u64 total_wait_us;
+		u32 max_wait_us;
+	} pktgo_stats;
 };
 
+#define DSIM_CMD_QUEUE_MAX_DEPTH	32
+
 extern struct dsim_device *dsim_drvdata[MAX_DSI_CNT];
 
 #define encoder_to_dsim(e) container_of(e, struct dsim_device, encoder)
@@ -161,6 +248,48 @@ dsim_get_decon(const struct dsim_device *dsim)
 	return to_exynos_crtc(crtc)->ctx;
 }
 
+#define PL_FIFO_THRESHOLD	mult_frac(MAX_PL_FIFO, 75, 100) /* 75% */
+#define IS_LAST(flags)		(((flags) & MIPI_DSI_MSG_LASTCOMMAND) != 0)
+
+/**
+ * dsim_cmd_is_last - batching rule of command mode transfers
+ * @msg: message to be sent
+ * @force_batching: a transaction started by EXYNOS_DSI_MSG_FORCE_BATCH is pending
+ * @pend_ph: packet headers pending in fifo
+ * @pend_pl: payload bytes pending in fifo
+ * @fifo_full: set if @msg only releases the batch because fifo is about to fill up
+ *
+ * Returns true if pending batch is released with @msg. Shared with the link model in
+ * exynos_drm_dsim_model.c, which has to follow the same rules.
+ */
+static inline bool dsim_cmd_is_last(const struct mipi_dsi_msg *msg, bool force_batching,
+				    u32 pend_ph, u32 pend_pl, bool *fifo_full)
+{
+	const bool is_empty_msg = !msg->tx_buf || msg->tx_len == 0;
+
+	*fifo_full = false;
+
+	if ((IS_LAST(msg->flags) && !force_batching) ||
+	    (msg->flags & EXYNOS_DSI_MSG_FORCE_FLUSH))
+		return true;
+
+	if (!is_empty_msg && (((pend_ph + 1) == MAX_PH_FIFO) ||
+	    ((pend_pl + msg->tx_len) > PL_FIFO_THRESHOLD))) {
+		*fifo_full = true;
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * dsim_exit_ulps_async - start PHY power on and ULPS exit in background
+ * @dsim: dsim device
+ *
+ * Runs dsim runtime resume from a work, a later runtime resume waits for it.
+ */
+void dsim_exit_ulps_async(struct dsim_device *dsim);
+
 #ifdef CONFIG_DEBUG_FS
 void dsim_diag_create_debugfs(struct dsim_device *dsim);
 void dsim_diag_remove_debugfs(struct dsim_device *dsim);
@@ -0,0 +1,568 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/* exynos_drm_dsim_model.c
+ *
+ * Copyright (C) 2026 Google, Inc.
+ *
+ * Link model of Exynos MIPI-DSI host, to measure panel command sequences without panel
+ * or display hardware. A fake mipi_dsi_host accounts transfers with the batching rules
+ * and fifo limits of dsim instead of sending them, and answers reads with canned
+ * emulator panel registers.
+ *
+ * Sequences of the panel probed for the "panel" compatible are replayed on a separate
+ * panel context, reading any of these debugfs nodes runs one and prints commands, bytes
+ * and modeled link time of each step:
+ *
+ *   dsim_model/panel_init	id/extinfo reads and panel enable
+ *   dsim_model/mode_switch	seamless switch through all modes
+ *   dsim_model/lhbm		local hbm on and off at peak refresh rate
+ */
+
+#include <linux/debugfs.h>
+#include <linux/module.h>
+#include <linux/of.h>
+#include <linux/of_device.h>
+#include <linux/platform_device.h>
+#include <linux/seq_file.h>
+#include <drm/drm_mipi_dsi.h>
+#include <video/mipi_display.h>
+
+#include "exynos_drm_dsim.h"
+#include "panel/panel-samsung-drv.h"
+
+static char *panel = "samsung,emul";
+module_param(panel, charp, 0600);
+MODULE_PARM_DESC(panel, "compatible of the panel whose sequences are replayed");
+
+static uint lane_mbps = 1000;
+module_param(lane_mbps, uint, 0600);
+MODULE_PARM_DESC(lane_mbps, "modeled lane rate in Mbps");
+
+/* modeled link costs, in ns */
+#define DSIM_MODEL_HS_ENTRY_NS		1500	/* LP to HS and back around a burst */
+#define DSIM_MODEL_BTA_NS		12000	/* bus turnaround and response in LP */
+#define DSIM_MODEL_PH_BYTES		4
+#define DSIM_MODEL_PL_CRC_BYTES		2
+
+struct dsim_model_stats {
+	u64 packets;
+	u64 payload_bytes;
+	u64 reads;
+	u64 bursts;
+	u64 fifo_flushes;
+	u64 link_ns;
+};
+
+struct dsim_model {
+	struct platform_device *pdev;
+	struct mipi_dsi_host host;
+	struct mipi_dsi_device *dsi;
+	struct dentry *debugfs_root;
+	/* one sequence is replayed at a time */
+	struct mutex lock;
+
+	u32 lanes;
+	bool video_mode;
+
+	/* batching state, see dsim_cmd_is_last() */
+	bool force_batching;
+	u32 pend_ph;
+	u32 pend_pl;
+	u32 pend_bytes;
+	size_t max_rx_len;
+
+	struct dsim_model_stats stats;
+};
+
+static struct dsim_model *dsim_model;
+
+#define host_to_dsim_model(h)	container_of(h, struct dsim_model, host)
+
+/* canned emulator panel registers, anything else reads as zero */
+static const struct {
+	u8 reg;
+	u8 len;
+	u8 val[16];
+} dsim_model_regs[] = {
+	/* panel id at offset 6 */
+	{ 0xA1, 13, { 0, 0, 0, 0, 0, 0, 'E', 'M', 'U', 'L', 0x00, 0x00, 0x01 } },
+	/* SLSI DDIC id */
+	{ 0xD6, 5, { 'E', 'M', 'U', 'L', 0x01 } },
+	/* extinfo, build code of 0xDB maps to PVT revision */
+	{ 0xDA, 1, { 0x00 } },
+	{ 0xDB, 1, { 0x80 } },
+	{ 0xDC, 1, { 0x00 } },
+};
+
+static u64 dsim_model_hs_ns(const struct dsim_model *model, size_t bytes)
+{
+	if (!lane_mbps)
+		return 0;
+
+	return div_u64((u64)bytes * 8 * NSEC_PER_USEC, model->lanes * lane_mbps);
+}
+
+static void dsim_model_burst(struct dsim_model *model)
+{
+	if (!model->pend_ph)
+		return;
+
+	model->stats.link_ns += DSIM_MODEL_HS_ENTRY_NS +
+		dsim_model_hs_ns(model, model->pend_bytes);
+	model->stats.bursts++;
+	model->pend_ph = 0;
+	model->pend_pl = 0;
+	model->pend_bytes = 0;
+}
+
+static ssize_t dsim_model_read(struct dsim_model *model, u8 reg, void *rx_buf, size_t rx_len)
+{
+	size_t len = 0;
+	u32 i;
+
+	/* reads need the bus, pending batch goes out first */
+	dsim_model_burst(model);
+
+	/* maximum return packet size is only sent when it changes, as dsim does */
+	if (rx_len != model->max_rx_len) {
+		model->stats.link_ns += DSIM_MODEL_HS_ENTRY_NS +
+			dsim_model_hs_ns(model, DSIM_MODEL_PH_BYTES);
+		model->max_rx_len = rx_len;
+	}
+	model->stats.link_ns += DSIM_MODEL_HS_ENTRY_NS + DSIM_MODEL_BTA_NS +
+		dsim_model_hs_ns(model, DSIM_MODEL_PH_BYTES);
+	model->stats.reads++;
+
+	for (i = 0; i < ARRAY_SIZE(dsim_model_regs); i++) {
+		if (dsim_model_regs[i].reg == reg) {
+			len = min_t(size_t, dsim_model_regs[i].len, rx_len);
+			memcpy(rx_buf, dsim_model_regs[i].val, len);
+			break;
+		}
+	}
+	memset(rx_buf + len, 0, rx_len - len);
+
+	return rx_len;
+}
+
+static ssize_t dsim_model_read_batch(struct dsim_model *model, const struct mipi_dsi_msg *msg)
+{
+	const struct exynos_dsi_read_batch *batch =
+		container_of(msg, struct exynos_dsi_read_batch, msg);
+	u32 i;
+
+	for (i = 0; i < batch->num_reads; i++) {
+		struct exynos_dsi_read *r = &batch->reads[i];
+
+		r->ret = dsim_model_read(model, r->reg, r->rx_buf, r->rx_len);
+	}
+
+	return i;
+}
+
+static void dsim_model_add(struct dsim_model *model, const struct mipi_dsi_msg *msg)
+{
+	model->stats.packets++;
+	model->stats.payload_bytes += msg->tx_len;
+	model->pend_ph++;
+	model->pend_pl += ALIGN(msg->tx_len, 4);
+	model->pend_bytes += DSIM_MODEL_PH_BYTES;
+	if (mipi_dsi_packet_format_is_long(msg->type))
+		model->pend_bytes += msg->tx_len + DSIM_MODEL_PL_CRC_BYTES;
+}
+
+/* follows dsim_write_data() */
+static ssize_t dsim_model_write(struct dsim_model *model, const struct mipi_dsi_msg *msg)
+{
+	const bool is_empty_msg = !msg->tx_buf || msg->tx_len == 0;
+	bool is_last, fifo_full;
+
+	if (model->video_mode) {
+		if (!is_empty_msg) {
+			dsim_model_add(model, msg);
+			dsim_model_burst(model);
+		}
+		return msg->tx_len;
+	}
+
+	if (msg->flags & EXYNOS_DSI_MSG_FORCE_BATCH) {
+		model->force_batching = true;
+		return 0;
+	}
+
+	if (((model->pend_pl + msg->tx_len) > MAX_PL_FIFO) ||
+	    (model->pend_ph == MAX_PH_FIFO))
+		return -EINVAL;
+
+	is_last = dsim_cmd_is_last(msg, model->force_batching, model->pend_ph,
+				   model->pend_pl, &fifo_full);
+	if (msg->flags & EXYNOS_DSI_MSG_FORCE_FLUSH)
+		model->force_batching = false;
+	if (fifo_full)
+		model->stats.fifo_flushes++;
+
+	if (!is_empty_msg)
+		dsim_model_add(model, msg);
+
+	if (is_last)
+		dsim_model_burst(model);
+
+	return msg->tx_len;
+}
+
+static ssize_t dsim_model_transfer(struct mipi_dsi_host *host, const struct mipi_dsi_msg *msg)
+{
+	struct dsim_model *model = host_to_dsim_model(host);
+	ssize_t ret;
+
+	switch (msg->type) {
+	case MIPI_DSI_DCS_READ:
+	case MIPI_DSI_GENERIC_READ_REQUEST_0_PARAM:
+	case MIPI_DSI_GENERIC_READ_REQUEST_1_PARAM:
+	case MIPI_DSI_GENERIC_READ_REQUEST_2_PARAM:
+		if (msg->flags & EXYNOS_DSI_MSG_READ_BATCH)
+			return dsim_model_read_batch(model, msg);
+
+		return dsim_model_read(model, msg->tx_len ? ((const u8 *)msg->tx_buf)[0] : 0,
+				       msg->rx_buf, msg->rx_len);
+	default:
+		break;
+	}
+
+	ret = dsim_model_write(model, msg);
+
+	/* async messages are accounted in order right away */
+	if (msg->flags & EXYNOS_DSI_MSG_ASYNC) {
+		const struct exynos_dsi_async_msg *amsg =
+			container_of(msg, struct exynos_dsi_async_msg, msg);
+
+		if (amsg->complete)
+			amsg->complete(amsg->data, ret < 0 ? ret : 0);
+	}
+
+	return ret;
+}
+
+static int dsim_model_attach(struct mipi_dsi_host *host, struct mipi_dsi_device *dsi)
+{
+	return 0;
+}
+
+static int dsim_model_detach(struct mipi_dsi_host *host, struct mipi_dsi_device *dsi)
+{
+	return 0;
+}
+
+static const struct mipi_dsi_host_ops dsim_model_host_ops = {
+	.attach = dsim_model_attach,
+	.detach = dsim_model_detach,
+	.transfer = dsim_model_transfer,
+};
+
+static void dsim_model_begin(struct dsim_model *model, const struct exynos_panel *ctx)
+{
+	model->lanes = ctx->desc->data_lane_cnt ? : 1;
+	model->video_mode = !!(ctx->current_mode->exynos_mode.mode_flags & MIPI_DSI_MODE_VIDEO);
+	model->force_batching = false;
+	model->pend_ph = 0;
+	model->pend_pl = 0;
+	model->pend_bytes = 0;
+	memset(&model->stats, 0, sizeof(model->stats));
+}
+
+static void dsim_model_end(struct seq_file *m, struct dsim_model *model, const char *step)
+{
+	const struct dsim_model_stats *s = &model->stats;
+
+	/* a batch left open by the sequence still has to go out */
+	dsim_model_burst(model);
+
+	seq_printf(m, "%s: cmds %llu bytes %llu reads %llu bursts %llu (fifo flushes %llu) link %lluns\n",
+		   step, s->packets, s->payload_bytes, s->reads, s->bursts, s->fifo_flushes,
+		   s->link_ns);
+}
+
+/* brings the panel up the way bridge pre_enable/enable do */
+static int dsim_model_panel_on(struct exynos_panel *ctx)
+{
+	const struct drm_panel_funcs *funcs = ctx->desc->panel_func;
+	int ret;
+
+	if (!funcs || !funcs->enable)
+		return -EOPNOTSUPP;
+
+	ret = exynos_panel_init(ctx);
+	if (ret)
+		return ret;
+
+	ret = funcs->enable(&ctx->panel);
+	if (ret)
+		return ret;
+
+	ctx->panel_state = PANEL_STATE_NORMAL;
+
+	return 0;
+}
+
+static int dsim_model_panel_init(struct seq_file *m, struct dsim_model *model,
+				 struct exynos_panel *ctx)
+{
+	char step[64];
+	int ret;
+
+	scnprintf(step, sizeof(step), "init %s", ctx->current_mode->mode.name);
+
+	dsim_model_begin(model, ctx);
+	ret = dsim_model_panel_on(ctx);
+	if (!ret)
+		dsim_model_end(m, model, step);
+
+	return ret;
+}
+
+static bool dsim_model_can_switch(struct exynos_panel *ctx, const struct exynos_panel_mode *pmode)
+{
+	const struct exynos_panel_funcs *funcs = ctx->desc->exynos_panel_func;
+
+	/* other switches go through a full modeset */
+	return pmode != ctx->current_mode && !pmode->exynos_mode.is_lp_mode &&
+	       (!funcs->is_mode_seamless || funcs->is_mode_seamless(ctx, pmode));
+}
+
+static int dsim_model_mode_switch(struct seq_file *m, struct dsim_model *model,
+				  struct exynos_panel *ctx)
+{
+	const struct exynos_panel_funcs *funcs = ctx->desc->exynos_panel_func;
+	char step[64];
+	int i, ret;
+
+	if (!funcs || !funcs->mode_set)
+		return -EOPNOTSUPP;
+
+	ret = dsim_model_panel_on(ctx);
+	if (ret)
+		return ret;
+
+	for (i = 1; i <= ctx->desc->num_modes; i++) {
+		const struct exynos_panel_mode *pmode = &ctx->desc->modes[i % ctx->desc->num_modes];
+
+		if (!dsim_model_can_switch(ctx, pmode))
+			continue;
+
+		scnprintf(step, sizeof(step), "%s -> %s", ctx->current_mode->mode.name,
+			  pmode->mode.name);
+
+		dsim_model_begin(model, ctx);
+		funcs->mode_set(ctx, pmode);
+		ctx->current_mode = pmode;
+		dsim_model_end(m, model, step);
+	}
+
+	return 0;
+}
+
+static int dsim_model_lhbm(struct seq_file *m, struct dsim_model *model,
+			   struct exynos_panel *ctx)
+{
+	const struct exynos_panel_funcs *funcs = ctx->desc->exynos_panel_func;
+	int i, ret;
+
+	if (!funcs || !funcs->set_local_hbm_mode)
+		return -EOPNOTSUPP;
+
+	ret = dsim_model_panel_on(ctx);
+	if (ret)
+		return ret;
+
+	/* LHBM is only allowed at peak refresh rate, get there first */
+	for (i = 0; i < ctx->desc->num_modes; i++) {
+		const struct exynos_panel_mode *pmode = &ctx->desc->modes[i];
+
+		if (drm_mode_vrefresh(&ctx->current_mode->mode) == ctx->peak_vrefresh)
+			break;
+
+		if (drm_mode_vrefresh(&pmode->mode) != ctx->peak_vrefresh ||
+		    !funcs->mode_set || !dsim_model_can_switch(ctx, pmode))
+			continue;
+
+		funcs->mode_set(ctx, pmode);
+		ctx->current_mode = pmode;
+	}
+
+	/* post enabling work of some panels isn't part of the sequence */
+	dsim_model_begin(model, ctx);
+	ctx->hbm.local_hbm.state = LOCAL_HBM_ENABLED;
+	funcs->set_local_hbm_mode(ctx, true);
+	dsim_model_end(m, model, "lhbm on");
+
+	dsim_model_begin(model, ctx);
+	ctx->hbm.local_hbm.state = LOCAL_HBM_DISABLED;
+	funcs->set_local_hbm_mode(ctx, false);
+	dsim_model_end(m, model, "lhbm off");
+
+	return 0;
+}
+
+/*
+ * Get desc of the probed panel matching @panel, its driver module is pinned on success.
+ * Panels with their own probe keep private state around exynos_panel and can't be used.
+ */
+static const struct exynos_panel_desc *dsim_model_get_desc(struct module **owner)
+{
+	const struct exynos_panel_desc *desc = NULL;
+	struct mipi_dsi_device *pdsi;
+	struct device_driver *drv;
+	struct device_node *np;
+
+	np = of_find_compatible_node(NULL, NULL, panel);
+	if (!np)
+		return ERR_PTR(-ENODEV);
+
+	pdsi = of_find_mipi_dsi_device_by_node(np);
+	of_node_put(np);
+	if (!pdsi)
+		return ERR_PTR(-ENODEV);
+
+	device_lock(&pdsi->dev);
+	drv = pdsi->dev.driver;
+	if (drv && to_mipi_dsi_driver(drv)->probe == exynos_panel_probe &&
+	    try_module_get(drv->owner)) {
+		desc = of_device_get_match_data(&pdsi->dev);
+		*owner = drv->owner;
+	}
+	device_unlock(&pdsi->dev);
+	put_device(&pdsi->dev);
+
+	if (!desc) {
+		pr_err("%s: no supported panel probed for %s\n", __func__, panel);
+		return ERR_PTR(-ENODEV);
+	}
+
+	return desc;
+}
+
+static int dsim_model_run(struct seq_file *m,
+			  int (*seq)(struct seq_file *m, struct dsim_model *model,
+				     struct exynos_panel *ctx))
+{
+	struct dsim_model *model = m->private;
+	const struct exynos_panel_desc *desc;
+	struct exynos_panel *ctx;
+	struct module *owner;
+	int ret;
+
+	desc = dsim_model_get_desc(&owner);
+	if (IS_ERR(desc))
+		return PTR_ERR(desc);
+
+	ctx = kzalloc(sizeof(*ctx), GFP_KERNEL);
+	if (!ctx) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	mutex_lock(&model->lock);
+	exynos_panel_model_init(model->dsi, ctx, desc);
+	seq_printf(m, "panel: %s lanes: %u rate: %uMbps\n", panel, desc->data_lane_cnt,
+		   lane_mbps);
+	ret = seq(m, model, ctx);
+	model->max_rx_len = 0;
+	mipi_dsi_set_drvdata(model->dsi, NULL);
+	mutex_unlock(&model->lock);
+
+	exynos_panel_model_free(ctx);
+	kfree(ctx);
+out:
+	module_put(owner);
+
+	return ret;
+}
+
+static int dsim_model_panel_init_show(struct seq_file *m, void *data)
+{
+	return dsim_model_run(m, dsim_model_panel_init);
+}
+DEFINE_SHOW_ATTRIBUTE(dsim_model_panel_init);
+
+static int dsim_model_mode_switch_show(struct seq_file *m, void *data)
+{
+	return dsim_model_run(m, dsim_model_mode_switch);
+}
+DEFINE_SHOW_ATTRIBUTE(dsim_model_mode_switch);
+
+static int dsim_model_lhbm_show(struct seq_file *m, void *data)
+{
+	return dsim_model_run(m, dsim_model_lhbm);
+}
+DEFINE_SHOW_ATTRIBUTE(dsim_model_lhbm);
+
+static int __init dsim_model_init(void)
+{
+	const struct mipi_dsi_device_info info = {
+		.type = "exynos-dsim-model",
+		.channel = 0,
+	};
+	struct dsim_model *model;
+	int ret;
+
+	model = kzalloc(sizeof(*model), GFP_KERNEL);
+	if (!model)
+		return -ENOMEM;
+
+	mutex_init(&model->lock);
+
+	model->pdev = platform_device_register_simple("exynos-dsim-model", -1, NULL, 0);
+	if (IS_ERR(model->pdev)) {
+		ret = PTR_ERR(model->pdev);
+		goto err_free;
+	}
+
+	model->host.dev = &model->pdev->dev;
+	model->host.ops = &dsim_model_host_ops;
+	ret = mipi_dsi_host_register(&model->host);
+	if (ret)
+		goto err_pdev;
+
+	model->dsi = mipi_dsi_device_register_full(&model->host, &info);
+	if (IS_ERR(model->dsi)) {
+		ret = PTR_ERR(model->dsi);
+		goto err_host;
+	}
+
+	model->debugfs_root = debugfs_create_dir("dsim_model", NULL);
+	debugfs_create_file("panel_init", 0400, model->debugfs_root, model,
+			    &dsim_model_panel_init_fops);
+	debugfs_create_file("mode_switch", 0400, model->debugfs_root, model,
+			    &dsim_model_mode_switch_fops);
+	debugfs_create_file("lhbm", 0400, model->debugfs_root, model,
+			    &dsim_model_lhbm_fops);
+
+	dsim_model = model;
+
+	return 0;
+
+err_host:
+	mipi_dsi_host_unregister(&model->host);
+err_pdev:
+	platform_device_unregister(model->pdev);
+err_free:
+	kfree(model);
+
+	return ret;
+}
+
+static void __exit dsim_model_exit(void)
+{
+	struct dsim_model *model = dsim_model;
+
+	debugfs_remove_recursive(model->debugfs_root);
+	/* also unregisters the model device */
+	mipi_dsi_host_unregister(&model->host);
+	platform_device_unregister(model->pdev);
+	kfree(model);
+}
+
+module_init(dsim_model_init);
+module_exit(dsim_model_exit);
+
+MODULE_DESCRIPTION("Link model of Exynos MIPI-DSI host for panel command sequences");
+MODULE_LICENSE("GPL");
@@ -288,12 +288,10 @@ static void plane_state_to_win_config(struct dpu_bts_win_config *win_config,
 	DRM_DEBUG("simplified rot[0x%x]\n", simplified_rot);
 }
 
-static void conn_state_to_win_config(struct dpu_bts_win_config *win_config,
-				const struct drm_connector_state *conn_state)
+static void wb_fb_to_win_config(struct dpu_bts_win_config *win_config,
+				const struct writeback_device *wb,
+				const struct drm_framebuffer *fb)
 {
-	const struct writeback_device *wb = conn_to_wb_dev(conn_state->connector);
-	const struct drm_framebuffer *fb = conn_state->writeback_job->fb;
-
 	win_config->src_x = 0;
 	win_config->src_y = 0;
 	win_config->src_w = fb->width;
@@ -322,6 +320,13 @@ static void conn_state_to_win_config(struct dpu_bts_win_config *win_config,
 			win_config->comp_src);
 }
 
+static void conn_state_to_win_config(struct dpu_bts_win_config *win_config,
+				const struct drm_connector_state *conn_state)
+{
+	wb_fb_to_win_config(win_config, conn_to_wb_dev(conn_state->connector),
+			conn_state->writeback_job->fb);
+}
+
 static void exynos_atomic_bts_pre_update(struct drm_device *dev,
 					 struct drm_atomic_state *old_state)
 {
@@ -404,6 +409,20 @@ static void exynos_atomic_bts_pre_update(struct drm_device *dev,
 		if (!new_crtc_state->active)
 			continue;
 
+		/* streaming writeback isn't part of atomic state */
+		if (to_exynos_crtc_state(new_crtc_state)->wb_type == EXYNOS_WB_NONE) {
+			struct writeback_device *wb = decon_get_wb(decon);
+			struct drm_framebuffer *fb = writeback_stream_get_fb(wb);
+
+			win_config = &decon->bts.wb_config;
+			if (fb) {
+				wb_fb_to_win_config(win_config, wb, fb);
+				drm_framebuffer_put(fb);
+			} else {
+				win_config->state = DPU_WIN_STATE_DISABLED;
+			}
+		}
+
 		if (new_crtc_state->planes_changed) {
 			const size_t num_planes =
 				hweight32(new_crtc_state->plane_mask &
@@ -515,6 +534,8 @@ void exynos_rmem_register(struct decon_device *decon)
 	struct reserved_mem *rmem;
 	struct device *dev = decon->dev;
 
+	mutex_init(&decon->fb_handover.lock);
+
 	np = dev->of_node;
 
 	rmem_np = of_parse_phandle(np, "memory-region", 0);
@@ -543,6 +564,92 @@ static void exynos_rmem_free(struct decon_device *decon)
 	decon->fb_handover.phys_size = 0;
 }
 
+static void exynos_rmem_gem_release(void *data)
+{
+	struct decon_device *decon = data;
+	struct exynos_fb_handover *handover = &decon->fb_handover;
+
+	mutex_lock(&handover->lock);
+	handover->gem = NULL;
+	if (handover->handed_over && handover->rmem) {
+		pr_info("decon%u: releasing bootloader framebuffer\n", decon->id);
+		exynos_rmem_free(decon);
+	}
+	mutex_unlock(&handover->lock);
+}
+
+/*
+ * Called on the first update after bootloader handover. Reserved memory is
+ * released right away unless userspace imported it, in which case it goes
+ * away with the last reference to the GEM object.
+ */
+static void exynos_rmem_handover_done(struct decon_device *decon)
+{
+	struct exynos_fb_handover *handover = &decon->fb_handover;
+
+	mutex_lock(&handover->lock);
+	handover->handed_over = true;
+	if (handover->rmem && !handover->gem)
+		exynos_rmem_free(decon);
+	mutex_unlock(&handover->lock);
+}
+
+int exynos_drm_fb_handover_ioctl(struct drm_device *dev, void *data,
+				 struct drm_file *file)
+{
+	struct exynos_drm_fb_handover *args = data;
+	struct exynos_fb_handover *handover;
+	struct exynos_drm_gem *exynos_gem_obj;
+	struct decon_device *decon;
+	struct drm_crtc *crtc;
+	int ret;
+
+	crtc = drm_crtc_find(dev, file, args->crtc_id);
+	if (!crtc)
+		return -ENOENT;
+
+	decon = crtc_to_decon(crtc);
+	handover = &decon->fb_handover;
+
+	mutex_lock(&handover->lock);
+	if (!handover->rmem) {
+		ret = -ENODEV;
+		goto out_unlock;
+	}
+
+	exynos_gem_obj = handover->gem;
+	if (exynos_gem_obj) {
+		/* previous object is on its way out along with the memory */
+		if (!kref_get_unless_zero(&exynos_gem_obj->base.refcount)) {
+			ret = -EAGAIN;
+			goto out_unlock;
+		}
+	} else {
+		exynos_gem_obj = exynos_drm_gem_create_phys(dev,
+				handover->phys_addr, handover->phys_size,
+				exynos_rmem_gem_release, decon);
+		if (IS_ERR(exynos_gem_obj)) {
+			ret = PTR_ERR(exynos_gem_obj);
+			goto out_unlock;
+		}
+		handover->gem = exynos_gem_obj;
+	}
+
+	args->size = exynos_gem_obj->base.size;
+	ret = drm_gem_handle_create(file, &exynos_gem_obj->base, &args->handle);
+	mutex_unlock(&handover->lock);
+
+	/* drop ref from lookup or creation - handle holds it now */
+	drm_gem_object_put(&exynos_gem_obj->base);
+
+	return ret;
+
+out_unlock:
+	mutex_unlock(&handover->lock);
+
+	return ret;
+}
+
 
 static void exynos_atomic_commit_tail(struct drm_atomic_state *old_state)
 {
@@ -590,6 +697,12 @@ static void exynos_atomic_commit_tail(struct drm_atomic_state *old_state)
 			hibernation_crtc_mask |= drm_crtc_mask(crtc);
 		}
 
+		/* commits toggling hibernation are not part of frame cadence */
+		if (new_crtc_state->active && !new_crtc_state->self_refresh_active &&
+		    !to_exynos_crtc_state(new_crtc_state)->hibernation_exit)
+			exynos_hibernation_record_commit(decon->hibernation,
+					old_crtc_state->self_refresh_active);
+
 		if (drm_atomic_crtc_effectively_active(old_crtc_state) && !new_crtc_state->active) {
 			/* keep runtime vote while disabling is taking place */
 			pm_runtime_get_sync(decon->dev);
@@ -624,6 +737,12 @@ static void exynos_atomic_commit_tail(struct drm_atomic_state *old_state)
 	drm_atomic_helper_commit_modeset_enables(dev, old_state);
 	DPU_ATRACE_END("modeset");
 
+	for_each_oldnew_crtc_in_state(old_state, crtc, old_crtc_state,
+			new_crtc_state, i) {
+		if (old_crtc_state->self_refresh_active && new_crtc_state->active)
+			exynos_hibernation_stats_exit_done(crtc_to_decon(crtc)->hibernation);
+	}
+
 	DPU_ATRACE_BEGIN("connector_pre_commit");
 	for_each_oldnew_connector_in_state(old_state, connector,
 				 old_conn_state, new_conn_state, i) {
@@ -701,12 +820,12 @@ static void exynos_atomic_commit_tail(struct drm_atomic_state *old_state)
 			hibernation_unblock_enter(decon->hibernation);
 		if (disabling_crtc_mask & drm_crtc_mask(crtc))
 			pm_runtime_put_sync(decon->dev);
-		if (decon->fb_handover.rmem) {
+		if (exynos_fb_handover_pending(&decon->fb_handover)) {
 			struct exynos_drm_crtc_state *exynos_crtc_state =
 				to_exynos_crtc_state(new_crtc_state);
 
 			if (!exynos_crtc_state->skip_update)
-				exynos_rmem_free(decon);
+				exynos_rmem_handover_done(decon);
 		}
 	}
 
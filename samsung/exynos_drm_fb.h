@@ -16,6 +16,7 @@
 #define _EXYNOS_DRM_FB_H_
 
 #include <linux/dma-buf.h>
+#include <uapi/drm/exynos_drm_ext.h>
 
 #include "exynos_drm_gem.h"
 
@@ -25,8 +26,21 @@ struct exynos_fb_handover {
 	phys_addr_t phys_addr;
 	size_t phys_size;
 	struct reserved_mem *rmem;
+
+	/* protects below and release of rmem */
+	struct mutex lock;
+	/* GEM object wrapping rmem, while userspace holds it */
+	struct exynos_drm_gem *gem;
+	/* set once DECON stops scanning out the bootloader image */
+	bool handed_over;
 };
 
+/* true while DECON still scans out the bootloader image */
+static inline bool exynos_fb_handover_pending(const struct exynos_fb_handover *h)
+{
+	return h->rmem && !h->handed_over;
+}
+
 static inline bool exynos_drm_fb_is_colormap(const struct drm_framebuffer *fb)
 {
 	const struct exynos_drm_gem *exynos_gem = to_exynos_gem(fb->obj[0]);
@@ -39,5 +53,7 @@ void *exynos_drm_fb_to_vaddr(const struct drm_framebuffer *fb);
 
 void exynos_drm_mode_config_init(struct drm_device *dev);
 void exynos_rmem_register(struct decon_device *decon);
+int exynos_drm_fb_handover_ioctl(struct drm_device *dev, void *data,
+				 struct drm_file *file);
 
 #endif
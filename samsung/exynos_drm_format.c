@@ -12,6 +12,7 @@
 
 #include <drm/drm_print.h>
 #include <uapi/drm/drm_fourcc.h>
+#include <drm/samsung_drm.h>
 
 #include <dpp_cal.h>
 #include <regs-dpp.h>
@@ -262,3 +263,32 @@ const struct dpu_fmt *dpu_find_fmt_info(u32 fmt)
 
 	return NULL;
 }
+
+/*
+ * Returns modifier class of @modifier, or -EINVAL if it is not supported by
+ * any DPP. Content protection bit is orthogonal to the memory layout.
+ */
+int dpu_get_mod_class(u64 modifier)
+{
+	modifier &= ~DRM_FORMAT_MOD_PROTECTION;
+
+	if (!modifier)
+		return DPU_MOD_CLASS_LINEAR;
+	if (has_all_bits(DRM_FORMAT_MOD_ARM_AFBC(0), modifier))
+		return DPU_MOD_CLASS_AFBC;
+	if (has_all_bits(DRM_FORMAT_MOD_SAMSUNG_SBWC(0), modifier))
+		return DPU_MOD_CLASS_SBWC;
+
+	return -EINVAL;
+}
+
+const char *dpu_get_mod_class_name(enum dpu_mod_class mod_class)
+{
+	static const char * const names[DPU_MOD_CLASS_MAX] = {
+		[DPU_MOD_CLASS_LINEAR]	= "linear",
+		[DPU_MOD_CLASS_AFBC]	= "afbc",
+		[DPU_MOD_CLASS_SBWC]	= "sbwc",
+	};
+
+	return mod_class < DPU_MOD_CLASS_MAX ? names[mod_class] : "unknown";
+}
@@ -25,6 +25,21 @@ enum dpu_colorspace {
 	DPU_COLORSPACE_YUV422,
 };
 
+/* modifier families with distinct format support, see dpu_get_mod_class() */
+enum dpu_mod_class {
+	DPU_MOD_CLASS_LINEAR,
+	DPU_MOD_CLASS_AFBC,
+	DPU_MOD_CLASS_SBWC,
+	DPU_MOD_CLASS_MAX,
+};
+
+/* per (format, modifier class) capabilities of a DPP channel */
+#define DPU_FMT_CAP_SUPPORTED	BIT(0)
+#define DPU_FMT_CAP_ROT		BIT(1)
+#define DPU_FMT_CAP_SCALE	BIT(2)
+#define DPU_FMT_CAP_COMP	BIT(3)
+#define DPU_FMT_CAP_HDR		BIT(4)
+
 struct dpu_fmt {
 	const char *name;
 	u32 fmt;		   /* user-interfaced color format */
@@ -77,6 +92,8 @@ struct dpu_fmt {
 						SBWC_8B_STRIDE(w))
 
 const struct dpu_fmt *dpu_find_fmt_info(u32 fmt);
+int dpu_get_mod_class(u64 modifier);
+const char *dpu_get_mod_class_name(enum dpu_mod_class mod_class);
 
 static inline const char *dpu_get_fmt_name(const struct dpu_fmt *fmt)
 {
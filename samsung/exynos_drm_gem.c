@@ -18,10 +18,575 @@
 #include <linux/fs.h>
 #include <linux/mm_types.h>
 #include <linux/dma-heap.h>
+#include <linux/dma-mapping.h>
+#include <linux/scatterlist.h>
+#include <linux/seq_file.h>
+
+#include <trace/dpu_trace.h>
 
 #include "exynos_drm_dsim.h"
 #include "exynos_drm_gem.h"
 
+#define EXYNOS_GEM_MAP_CACHE_REAP_DELAY	HZ
+
+/*
+ * Import of a dma-buf that outlived its GEM object, parked either in the dumb
+ * buffer pool or in the mapping cache. bucket_node is only used by the pool.
+ */
+struct exynos_drm_gem_import {
+	struct list_head bucket_node;
+	struct list_head lru_node;
+	struct dma_buf_attachment *attach;
+	struct sg_table *sgt;
+	dma_addr_t dma_addr;
+	void *vaddr;
+	size_t size;
+};
+
+static inline struct exynos_drm_gem_pool *to_gem_pool(struct drm_device *dev)
+{
+	return &drm_to_exynos_dev(dev)->gem_pool;
+}
+
+static int exynos_drm_gem_pool_bucket(size_t size)
+{
+	const int order = get_order(size);
+
+	return order < EXYNOS_GEM_POOL_BUCKETS ? order : -1;
+}
+
+static void
+exynos_drm_gem_pool_unlink(struct exynos_drm_gem_pool *pool,
+			   struct exynos_drm_gem_import *entry)
+{
+	list_del(&entry->bucket_node);
+	list_del(&entry->lru_node);
+	pool->cur_bytes -= entry->size;
+}
+
+/* moves least recently recycled entries to @list until @target is met */
+static unsigned int
+exynos_drm_gem_pool_evict_locked(struct exynos_drm_gem_pool *pool,
+				 size_t target, struct list_head *list)
+{
+	struct exynos_drm_gem_import *entry;
+	unsigned int count = 0;
+
+	while (pool->cur_bytes > target && !list_empty(&pool->lru)) {
+		entry = list_first_entry(&pool->lru,
+				struct exynos_drm_gem_import, lru_node);
+		exynos_drm_gem_pool_unlink(pool, entry);
+		list_add_tail(&entry->lru_node, list);
+		count++;
+	}
+
+	return count;
+}
+
+static inline struct exynos_drm_gem_map_cache *
+to_gem_map_cache(struct drm_device *dev)
+{
+	return &drm_to_exynos_dev(dev)->gem_map_cache;
+}
+
+static void
+exynos_drm_gem_import_release(struct exynos_drm_gem_import *entry)
+{
+	struct dma_buf *dma_buf = entry->attach->dmabuf;
+
+	if (entry->vaddr)
+		dma_buf_vunmap(dma_buf, entry->vaddr);
+	trace_dpu_gem_iommu_unmap(entry->size, entry->dma_addr);
+	dma_buf_unmap_attachment(entry->attach, entry->sgt, DMA_BIDIRECTIONAL);
+	dma_buf_detach(dma_buf, entry->attach);
+	dma_buf_put(dma_buf);
+	kfree(entry);
+}
+
+static unsigned long exynos_drm_gem_import_release_list(struct list_head *list)
+{
+	struct exynos_drm_gem_import *entry, *tmp;
+	unsigned long pages = 0;
+
+	list_for_each_entry_safe(entry, tmp, list, lru_node) {
+		pages += entry->size >> PAGE_SHIFT;
+		exynos_drm_gem_import_release(entry);
+	}
+
+	return pages;
+}
+
+/* wraps a parked import into a new GEM object, consuming @entry */
+static struct exynos_drm_gem *
+exynos_drm_gem_from_import(struct drm_device *dev,
+			   struct exynos_drm_gem_import *entry,
+			   unsigned int flags)
+{
+	struct exynos_drm_gem *exynos_gem_obj;
+
+	exynos_gem_obj = exynos_drm_gem_alloc(dev, entry->size, flags);
+	if (IS_ERR(exynos_gem_obj)) {
+		exynos_drm_gem_import_release(entry);
+		return exynos_gem_obj;
+	}
+
+	exynos_gem_obj->sgt = entry->sgt;
+	exynos_gem_obj->dma_addr = entry->dma_addr;
+	exynos_gem_obj->vaddr = entry->vaddr;
+	exynos_gem_obj->base.import_attach = entry->attach;
+	exynos_gem_obj->base.resv = entry->attach->dmabuf->resv;
+	kfree(entry);
+
+	return exynos_gem_obj;
+}
+
+static struct dma_heap *exynos_drm_gem_pool_heap(struct exynos_drm_gem_pool *pool)
+{
+	struct dma_heap *heap;
+
+	mutex_lock(&pool->lock);
+	/* heap may be registered after bind, so look it up on first use only */
+	if (!pool->heap)
+		pool->heap = dma_heap_find("system");
+	heap = pool->heap;
+	mutex_unlock(&pool->lock);
+
+	return heap;
+}
+
+/*
+ * Takes over the import of a dumb buffer being freed. Only buffers that are
+ * not shared outside of this driver are recycled, since the contents of a
+ * recycled buffer are handed to a different owner on the next allocation.
+ */
+static bool exynos_drm_gem_pool_put(struct exynos_drm_gem_pool *pool,
+				    struct exynos_drm_gem *exynos_gem_obj)
+{
+	struct dma_buf_attachment *attach = exynos_gem_obj->base.import_attach;
+	struct exynos_drm_gem_import *entry;
+	struct dma_buf *dma_buf;
+	LIST_HEAD(evicted);
+	int bucket;
+
+	if (!(exynos_gem_obj->flags & EXYNOS_DRM_GEM_FLAG_DUMB_BUF) || !attach)
+		return false;
+
+	dma_buf = attach->dmabuf;
+	bucket = exynos_drm_gem_pool_bucket(dma_buf->size);
+	if (bucket < 0 || dma_buf->size > READ_ONCE(pool->max_bytes) ||
+	    file_count(dma_buf->file) > 1)
+		goto reject;
+
+	if (!exynos_gem_obj->vaddr) {
+		exynos_gem_obj->vaddr = dma_buf_vmap(dma_buf);
+		if (!exynos_gem_obj->vaddr)
+			goto reject;
+	}
+
+	entry = kmalloc(sizeof(*entry), GFP_KERNEL);
+	if (!entry)
+		goto reject;
+
+	entry->attach = attach;
+	entry->sgt = exynos_gem_obj->sgt;
+	entry->dma_addr = exynos_gem_obj->dma_addr;
+	entry->vaddr = exynos_gem_obj->vaddr;
+	entry->size = dma_buf->size;
+
+	pr_debug("recycling %zu bytes dma_addr: 0x%llx\n", entry->size,
+			entry->dma_addr);
+
+	mutex_lock(&pool->lock);
+	if (pool->disabled) {
+		mutex_unlock(&pool->lock);
+		kfree(entry);
+		goto reject;
+	}
+
+	list_add_tail(&entry->bucket_node, &pool->buckets[bucket]);
+	list_add_tail(&entry->lru_node, &pool->lru);
+	pool->cur_bytes += entry->size;
+	pool->stats.recycled++;
+	pool->stats.evicted += exynos_drm_gem_pool_evict_locked(pool,
+			pool->max_bytes, &evicted);
+	mutex_unlock(&pool->lock);
+
+	exynos_drm_gem_import_release_list(&evicted);
+
+	return true;
+
+reject:
+	mutex_lock(&pool->lock);
+	pool->stats.rejected++;
+	mutex_unlock(&pool->lock);
+
+	return false;
+}
+
+static struct exynos_drm_gem *
+exynos_drm_gem_pool_get(struct drm_device *dev, size_t size, unsigned int flags)
+{
+	struct exynos_drm_gem_pool *pool = to_gem_pool(dev);
+	struct exynos_drm_gem_import *entry, *found = NULL;
+	struct exynos_drm_gem *exynos_gem_obj;
+	struct dma_buf *dma_buf;
+	const int bucket = exynos_drm_gem_pool_bucket(size);
+
+	if (bucket < 0)
+		return NULL;
+
+	mutex_lock(&pool->lock);
+	list_for_each_entry(entry, &pool->buckets[bucket], bucket_node) {
+		if (entry->size == size) {
+			found = entry;
+			exynos_drm_gem_pool_unlink(pool, found);
+			break;
+		}
+	}
+	if (found)
+		pool->stats.hits++;
+	else
+		pool->stats.misses++;
+	mutex_unlock(&pool->lock);
+
+	if (!found)
+		return NULL;
+
+	dma_buf = found->attach->dmabuf;
+
+	/* a fresh heap buffer is zeroed, keep that promise for recycled ones */
+	dma_buf_begin_cpu_access(dma_buf, DMA_BIDIRECTIONAL);
+	memset(found->vaddr, 0, size);
+	dma_buf_end_cpu_access(dma_buf, DMA_BIDIRECTIONAL);
+
+	exynos_gem_obj = exynos_drm_gem_from_import(dev, found, flags);
+	if (IS_ERR(exynos_gem_obj))
+		return exynos_gem_obj;
+
+	pr_debug("reused %zu bytes dma_addr: 0x%llx\n", size,
+			exynos_gem_obj->dma_addr);
+
+	return exynos_gem_obj;
+}
+
+static unsigned long
+exynos_drm_gem_pool_count(struct shrinker *shrinker, struct shrink_control *sc)
+{
+	struct exynos_drm_gem_pool *pool =
+		container_of(shrinker, struct exynos_drm_gem_pool, shrinker);
+	const unsigned long pages = READ_ONCE(pool->cur_bytes) >> PAGE_SHIFT;
+
+	return pages ?: SHRINK_EMPTY;
+}
+
+static unsigned long
+exynos_drm_gem_pool_scan(struct shrinker *shrinker, struct shrink_control *sc)
+{
+	struct exynos_drm_gem_pool *pool =
+		container_of(shrinker, struct exynos_drm_gem_pool, shrinker);
+	size_t reclaim = (size_t)sc->nr_to_scan << PAGE_SHIFT;
+	LIST_HEAD(evicted);
+
+	if (!mutex_trylock(&pool->lock))
+		return SHRINK_STOP;
+
+	reclaim = min(reclaim, pool->cur_bytes);
+	pool->stats.shrunk += exynos_drm_gem_pool_evict_locked(pool,
+			pool->cur_bytes - reclaim, &evicted);
+	mutex_unlock(&pool->lock);
+
+	return exynos_drm_gem_import_release_list(&evicted);
+}
+
+int exynos_drm_gem_pool_init(struct exynos_drm_gem_pool *pool)
+{
+	int i;
+
+	mutex_init(&pool->lock);
+	for (i = 0; i < EXYNOS_GEM_POOL_BUCKETS; i++)
+		INIT_LIST_HEAD(&pool->buckets[i]);
+	INIT_LIST_HEAD(&pool->lru);
+	pool->max_bytes = EXYNOS_GEM_POOL_DEFAULT_MAX;
+
+	pool->shrinker.count_objects = exynos_drm_gem_pool_count;
+	pool->shrinker.scan_objects = exynos_drm_gem_pool_scan;
+	pool->shrinker.seeks = DEFAULT_SEEKS;
+
+	return register_shrinker(&pool->shrinker);
+}
+
+void exynos_drm_gem_pool_fini(struct exynos_drm_gem_pool *pool)
+{
+	LIST_HEAD(evicted);
+
+	unregister_shrinker(&pool->shrinker);
+
+	mutex_lock(&pool->lock);
+	pool->disabled = true;
+	exynos_drm_gem_pool_evict_locked(pool, 0, &evicted);
+	if (pool->heap) {
+		dma_heap_put(pool->heap);
+		pool->heap = NULL;
+	}
+	mutex_unlock(&pool->lock);
+
+	exynos_drm_gem_import_release_list(&evicted);
+}
+
+void exynos_drm_gem_pool_show(struct exynos_drm_gem_pool *pool,
+			      struct seq_file *s)
+{
+	struct exynos_drm_gem_pool_stats stats;
+	size_t cur_bytes;
+	u64 lookups;
+
+	mutex_lock(&pool->lock);
+	stats = pool->stats;
+	cur_bytes = pool->cur_bytes;
+	mutex_unlock(&pool->lock);
+
+	lookups = stats.hits + stats.misses;
+
+	seq_printf(s, "size: %zuKB max: %zuKB\n", cur_bytes >> 10,
+			READ_ONCE(pool->max_bytes) >> 10);
+	seq_printf(s, "hits: %llu misses: %llu hit rate: %llu%%\n",
+			stats.hits, stats.misses,
+			lookups ? div64_u64(stats.hits * 100, lookups) : 0);
+	seq_printf(s, "recycled: %llu rejected: %llu evicted: %llu shrunk: %llu\n",
+			stats.recycled, stats.rejected, stats.evicted,
+			stats.shrunk);
+}
+
+static void
+exynos_drm_gem_map_cache_unlink(struct exynos_drm_gem_map_cache *cache,
+				struct exynos_drm_gem_import *entry)
+{
+	list_del(&entry->lru_node);
+	cache->count--;
+	cache->cur_bytes -= entry->size;
+}
+
+static unsigned int
+exynos_drm_gem_map_cache_evict_locked(struct exynos_drm_gem_map_cache *cache,
+				      u32 target, struct list_head *list)
+{
+	struct exynos_drm_gem_import *entry;
+	unsigned int count = 0;
+
+	while (cache->count > target) {
+		entry = list_first_entry(&cache->lru,
+				struct exynos_drm_gem_import, lru_node);
+		exynos_drm_gem_map_cache_unlink(cache, entry);
+		list_add_tail(&entry->lru_node, list);
+		count++;
+	}
+
+	return count;
+}
+
+/*
+ * Keeps the device mapping of an imported buffer after its GEM object is
+ * gone, as long as somebody else still holds the dma-buf and may import it
+ * again. Framebuffers of a recycled swapchain then skip the IOMMU map.
+ */
+static bool exynos_drm_gem_map_cache_put(struct exynos_drm_gem_map_cache *cache,
+					 struct exynos_drm_gem *exynos_gem_obj)
+{
+	struct dma_buf_attachment *attach = exynos_gem_obj->base.import_attach;
+	struct exynos_drm_gem_import *entry;
+	struct dma_buf *dma_buf;
+	LIST_HEAD(evicted);
+
+	if (!attach || !READ_ONCE(cache->max_count))
+		return false;
+
+	dma_buf = attach->dmabuf;
+	if (file_count(dma_buf->file) == 1)
+		return false;
+
+	entry = kmalloc(sizeof(*entry), GFP_KERNEL);
+	if (!entry)
+		return false;
+
+	if (exynos_gem_obj->vaddr) {
+		dma_buf_vunmap(dma_buf, exynos_gem_obj->vaddr);
+		exynos_gem_obj->vaddr = NULL;
+	}
+
+	entry->attach = attach;
+	entry->sgt = exynos_gem_obj->sgt;
+	entry->dma_addr = exynos_gem_obj->dma_addr;
+	entry->vaddr = NULL;
+	entry->size = dma_buf->size;
+
+	mutex_lock(&cache->lock);
+	if (cache->disabled) {
+		mutex_unlock(&cache->lock);
+		kfree(entry);
+		return false;
+	}
+
+	list_add_tail(&entry->lru_node, &cache->lru);
+	cache->count++;
+	cache->cur_bytes += entry->size;
+	cache->stats.inserted++;
+	cache->stats.evicted += exynos_drm_gem_map_cache_evict_locked(cache,
+			cache->max_count, &evicted);
+	schedule_delayed_work(&cache->reap_work,
+			EXYNOS_GEM_MAP_CACHE_REAP_DELAY);
+	mutex_unlock(&cache->lock);
+
+	exynos_drm_gem_import_release_list(&evicted);
+
+	return true;
+}
+
+static struct drm_gem_object *
+exynos_drm_gem_map_cache_get(struct drm_device *dev, struct dma_buf *dma_buf)
+{
+	struct exynos_drm_gem_map_cache *cache = to_gem_map_cache(dev);
+	struct exynos_drm_gem_import *entry, *found = NULL;
+	struct exynos_drm_gem *exynos_gem_obj;
+
+	mutex_lock(&cache->lock);
+	list_for_each_entry(entry, &cache->lru, lru_node) {
+		if (entry->attach->dmabuf == dma_buf) {
+			found = entry;
+			exynos_drm_gem_map_cache_unlink(cache, found);
+			break;
+		}
+	}
+	if (found)
+		cache->stats.hits++;
+	else
+		cache->stats.misses++;
+	mutex_unlock(&cache->lock);
+
+	if (!found)
+		return NULL;
+
+	trace_dpu_gem_iommu_reuse(found->size, found->dma_addr);
+
+	exynos_gem_obj = exynos_drm_gem_from_import(dev, found, 0);
+	if (IS_ERR(exynos_gem_obj))
+		return ERR_CAST(exynos_gem_obj);
+
+	return &exynos_gem_obj->base;
+}
+
+/* drops mappings of buffers which were released by everybody else */
+static void exynos_drm_gem_map_cache_reap(struct work_struct *work)
+{
+	struct exynos_drm_gem_map_cache *cache = container_of(to_delayed_work(work),
+			struct exynos_drm_gem_map_cache, reap_work);
+	struct exynos_drm_gem_import *entry, *tmp;
+	LIST_HEAD(reaped);
+
+	mutex_lock(&cache->lock);
+	list_for_each_entry_safe(entry, tmp, &cache->lru, lru_node) {
+		if (file_count(entry->attach->dmabuf->file) > 1)
+			continue;
+
+		exynos_drm_gem_map_cache_unlink(cache, entry);
+		list_add_tail(&entry->lru_node, &reaped);
+		cache->stats.reaped++;
+	}
+	if (cache->count && !cache->disabled)
+		schedule_delayed_work(&cache->reap_work,
+				EXYNOS_GEM_MAP_CACHE_REAP_DELAY);
+	mutex_unlock(&cache->lock);
+
+	exynos_drm_gem_import_release_list(&reaped);
+}
+
+static unsigned long
+exynos_drm_gem_map_cache_count(struct shrinker *shrinker,
+			       struct shrink_control *sc)
+{
+	struct exynos_drm_gem_map_cache *cache =
+		container_of(shrinker, struct exynos_drm_gem_map_cache, shrinker);
+
+	return READ_ONCE(cache->count) ?: SHRINK_EMPTY;
+}
+
+static unsigned long
+exynos_drm_gem_map_cache_scan(struct shrinker *shrinker,
+			      struct shrink_control *sc)
+{
+	struct exynos_drm_gem_map_cache *cache =
+		container_of(shrinker, struct exynos_drm_gem_map_cache, shrinker);
+	unsigned long freed;
+	LIST_HEAD(evicted);
+
+	if (!mutex_trylock(&cache->lock))
+		return SHRINK_STOP;
+
+	freed = exynos_drm_gem_map_cache_evict_locked(cache,
+			cache->count - min_t(unsigned long, sc->nr_to_scan,
+					     cache->count), &evicted);
+	cache->stats.shrunk += freed;
+	mutex_unlock(&cache->lock);
+
+	exynos_drm_gem_import_release_list(&evicted);
+
+	return freed;
+}
+
+int exynos_drm_gem_map_cache_init(struct exynos_drm_gem_map_cache *cache)
+{
+	mutex_init(&cache->lock);
+	INIT_LIST_HEAD(&cache->lru);
+	INIT_DELAYED_WORK(&cache->reap_work, exynos_drm_gem_map_cache_reap);
+	cache->max_count = EXYNOS_GEM_MAP_CACHE_DEFAULT_MAX;
+
+	cache->shrinker.count_objects = exynos_drm_gem_map_cache_count;
+	cache->shrinker.scan_objects = exynos_drm_gem_map_cache_scan;
+	cache->shrinker.seeks = DEFAULT_SEEKS;
+
+	return register_shrinker(&cache->shrinker);
+}
+
+void exynos_drm_gem_map_cache_fini(struct exynos_drm_gem_map_cache *cache)
+{
+	LIST_HEAD(evicted);
+
+	unregister_shrinker(&cache->shrinker);
+
+	mutex_lock(&cache->lock);
+	cache->disabled = true;
+	exynos_drm_gem_map_cache_evict_locked(cache, 0, &evicted);
+	mutex_unlock(&cache->lock);
+
+	cancel_delayed_work_sync(&cache->reap_work);
+	exynos_drm_gem_import_release_list(&evicted);
+}
+
+void exynos_drm_gem_map_cache_show(struct exynos_drm_gem_map_cache *cache,
+				   struct seq_file *s)
+{
+	struct exynos_drm_gem_map_cache_stats stats;
+	size_t cur_bytes;
+	u32 count;
+	u64 lookups;
+
+	mutex_lock(&cache->lock);
+	stats = cache->stats;
+	count = cache->count;
+	cur_bytes = cache->cur_bytes;
+	mutex_unlock(&cache->lock);
+
+	lookups = stats.hits + stats.misses;
+
+	seq_printf(s, "entries: %u/%u mapped: %zuKB\n", count,
+			READ_ONCE(cache->max_count), cur_bytes >> 10);
+	seq_printf(s, "hits: %llu misses: %llu hit rate: %llu%%\n",
+			stats.hits, stats.misses,
+			lookups ? div64_u64(stats.hits * 100, lookups) : 0);
+	seq_printf(s, "inserted: %llu evicted: %llu reaped: %llu shrunk: %llu\n",
+			stats.inserted, stats.evicted, stats.reaped,
+			stats.shrunk);
+}
+
 struct exynos_drm_gem *exynos_drm_gem_alloc(struct drm_device *dev,
 					    size_t size, unsigned int flags)
 {
@@ -41,6 +606,88 @@ struct exynos_drm_gem *exynos_drm_gem_alloc(struct drm_device *dev,
 	return exynos_gem_obj;
 }
 
+/*
+ * Wraps physically contiguous memory which is not backed by a dma-buf, such
+ * as the bootloader framebuffer, into a GEM object mapped for the DPU. Once
+ * the last reference is dropped @release is called to give the memory back.
+ */
+struct exynos_drm_gem *
+exynos_drm_gem_create_phys(struct drm_device *dev, phys_addr_t phys_addr,
+			   size_t size, void (*release)(void *data),
+			   void *release_data)
+{
+	struct exynos_drm_private *priv = drm_to_exynos_dev(dev);
+	struct exynos_drm_gem *exynos_gem_obj;
+	struct sg_table *sgt;
+	int ret;
+
+	if (!PAGE_ALIGNED(phys_addr) || !size)
+		return ERR_PTR(-EINVAL);
+
+	size = PAGE_ALIGN(size);
+
+	sgt = kzalloc(sizeof(*sgt), GFP_KERNEL);
+	if (!sgt)
+		return ERR_PTR(-ENOMEM);
+
+	ret = sg_alloc_table(sgt, 1, GFP_KERNEL);
+	if (ret)
+		goto err_free_sgt;
+
+	sg_set_page(sgt->sgl, phys_to_page(phys_addr), size, 0);
+
+	ret = dma_map_sgtable(priv->iommu_client, sgt, DMA_BIDIRECTIONAL, 0);
+	if (ret) {
+		pr_err("Failed to map %#zx bytes at %pa\n", size, &phys_addr);
+		goto err_free_table;
+	}
+
+	exynos_gem_obj = exynos_drm_gem_alloc(dev, size, EXYNOS_DRM_GEM_FLAG_PHYS);
+	if (IS_ERR(exynos_gem_obj)) {
+		ret = PTR_ERR(exynos_gem_obj);
+		goto err_unmap;
+	}
+
+	exynos_gem_obj->sgt = sgt;
+	exynos_gem_obj->dma_addr = sg_dma_address(sgt->sgl);
+	exynos_gem_obj->phys_addr = phys_addr;
+	exynos_gem_obj->release = release;
+	exynos_gem_obj->release_data = release_data;
+
+	trace_dpu_gem_iommu_map(size, exynos_gem_obj->dma_addr);
+
+	pr_debug("wrapped %pa size %#zx to dma_addr: 0x%llx\n", &phys_addr, size,
+			exynos_gem_obj->dma_addr);
+
+	return exynos_gem_obj;
+
+err_unmap:
+	dma_unmap_sgtable(priv->iommu_client, sgt, DMA_BIDIRECTIONAL, 0);
+err_free_table:
+	sg_free_table(sgt);
+err_free_sgt:
+	kfree(sgt);
+
+	return ERR_PTR(ret);
+}
+
+static void exynos_drm_gem_free_phys(struct exynos_drm_gem *exynos_gem_obj)
+{
+	struct drm_device *dev = exynos_gem_obj->base.dev;
+	struct exynos_drm_private *priv = drm_to_exynos_dev(dev);
+
+	trace_dpu_gem_iommu_unmap(exynos_gem_obj->base.size,
+			exynos_gem_obj->dma_addr);
+
+	dma_unmap_sgtable(priv->iommu_client, exynos_gem_obj->sgt,
+			DMA_BIDIRECTIONAL, 0);
+	sg_free_table(exynos_gem_obj->sgt);
+	kfree(exynos_gem_obj->sgt);
+
+	if (exynos_gem_obj->release)
+		exynos_gem_obj->release(exynos_gem_obj->release_data);
+}
+
 struct drm_gem_object *
 exynos_drm_gem_prime_import_sg_table(struct drm_device *dev,
 				     struct dma_buf_attachment *attach,
@@ -64,6 +711,8 @@ exynos_drm_gem_prime_import_sg_table(struct drm_device *dev,
 
 	exynos_gem_obj->dma_addr = dma_addr;
 
+	trace_dpu_gem_iommu_map(size, dma_addr);
+
 	pr_debug("mapped dma_addr: 0x%llx\n", exynos_gem_obj->dma_addr);
 
 	return &exynos_gem_obj->base;
@@ -88,11 +737,21 @@ void exynos_drm_gem_free_object(struct drm_gem_object *obj)
 
 	exynos_drm_gem_unmap(exynos_gem_obj);
 
-	if (obj->import_attach) {
+	if (exynos_gem_obj->flags & EXYNOS_DRM_GEM_FLAG_PHYS) {
+		exynos_drm_gem_free_phys(exynos_gem_obj);
+	} else if (exynos_drm_gem_pool_put(to_gem_pool(obj->dev),
+					   exynos_gem_obj) ||
+		   exynos_drm_gem_map_cache_put(to_gem_map_cache(obj->dev),
+						exynos_gem_obj)) {
+		/* import is owned by the pool or the mapping cache now */
+		obj->import_attach = NULL;
+	} else if (obj->import_attach) {
 		dma_buf = obj->import_attach->dmabuf;
 		if (dma_buf && exynos_gem_obj->vaddr)
 			dma_buf_vunmap(dma_buf, exynos_gem_obj->vaddr);
 
+		trace_dpu_gem_iommu_unmap(obj->size, exynos_gem_obj->dma_addr);
+
 		drm_prime_gem_destroy(obj, exynos_gem_obj->sgt);
 	}
 
@@ -125,6 +784,7 @@ static int exynos_drm_gem_create(struct drm_device *dev, struct drm_file *filep,
 	struct dma_heap *dma_heap;
 	struct dma_buf *dmabuf;
 	struct drm_gem_object *obj;
+	struct exynos_drm_gem *exynos_gem_obj;
 	int ret;
 
 	if (flags & EXYNOS_DRM_GEM_FLAG_COLORMAP) {
@@ -132,41 +792,46 @@ static int exynos_drm_gem_create(struct drm_device *dev, struct drm_file *filep,
 		return -EINVAL;
 	}
 
-	dma_heap = dma_heap_find("system");
+	exynos_gem_obj = exynos_drm_gem_pool_get(dev, size, flags);
+	if (IS_ERR(exynos_gem_obj))
+		return PTR_ERR(exynos_gem_obj);
+
+	if (exynos_gem_obj) {
+		obj = &exynos_gem_obj->base;
+		goto create_handle;
+	}
+
+	dma_heap = exynos_drm_gem_pool_heap(to_gem_pool(dev));
 	if (!dma_heap) {
 		pr_err("Failed to find DMA-BUF system heap\n");
 		return -EINVAL;
 	}
 
 	dmabuf = dma_heap_buffer_alloc(dma_heap, size, O_RDWR, 0);
-	dma_heap_put(dma_heap);
 	if (IS_ERR(dmabuf)) {
 		pr_err("Failed to allocate %#zx bytes from DMA-BUF system heap\n", size);
 		return PTR_ERR(dmabuf);
 	}
 
 	obj = exynos_drm_gem_prime_import(dev, dmabuf);
+
+	/* drop ref from alloc - import holds it now */
+	dma_buf_put(dmabuf);
+
 	if (IS_ERR(obj)) {
 		pr_err("Unable to import created DMA-BUF heap buffer\n");
-		ret = PTR_ERR(obj);
-	} else {
-		struct exynos_drm_gem *exynos_gem_obj = to_exynos_gem(obj);
-
-		exynos_gem_obj->flags |= flags;
+		return PTR_ERR(obj);
+	}
 
-		ret = drm_gem_handle_create(filep, obj, gem_handle);
-		if (ret) {
-			pr_err("Failed to create a handle of GEM\n");
-			/* drop ref from import */
-			dma_buf_put(dmabuf);
-		}
+	to_exynos_gem(obj)->flags |= flags;
 
-		/* drop ref from import - handle holds it now */
-		drm_gem_object_put(obj);
-	}
+create_handle:
+	ret = drm_gem_handle_create(filep, obj, gem_handle);
+	if (ret)
+		pr_err("Failed to create a handle of GEM\n");
 
-	/* drop ref from alloc - import holds it now */
-	dma_buf_put(dmabuf);
+	/* drop ref from import - handle holds it now */
+	drm_gem_object_put(obj);
 
 	return ret;
 }
@@ -198,10 +863,27 @@ struct drm_gem_object *exynos_drm_gem_prime_import(struct drm_device *dev,
 						   struct dma_buf *dma_buf)
 {
 	struct exynos_drm_private *priv = drm_to_exynos_dev(dev);
+	struct drm_gem_object *obj;
+
+	obj = exynos_drm_gem_map_cache_get(dev, dma_buf);
+	if (obj)
+		return obj;
 
 	return drm_gem_prime_import_dev(dev, dma_buf, priv->iommu_client);
 }
 
+struct dma_buf *exynos_drm_gem_prime_export(struct drm_gem_object *obj, int flags)
+{
+	/*
+	 * Wrapped physical memory has no sg table callback for importers to map
+	 * it through, keep it private to this device.
+	 */
+	if (to_exynos_gem(obj)->flags & EXYNOS_DRM_GEM_FLAG_PHYS)
+		return ERR_PTR(-EOPNOTSUPP);
+
+	return drm_gem_prime_export(obj, flags);
+}
+
 struct drm_gem_object *exynos_drm_gem_fd_to_obj(struct drm_device *dev, int val)
 {
 	struct dma_buf *dma_buf;
@@ -224,6 +906,11 @@ static int exynos_drm_gem_mmap_object(struct exynos_drm_gem *exynos_gem_obj,
 	struct dma_buf_attachment *attach = exynos_gem_obj->base.import_attach;
 	int ret;
 
+	if (exynos_gem_obj->flags & EXYNOS_DRM_GEM_FLAG_PHYS)
+		return remap_pfn_range(vma, vma->vm_start,
+				PHYS_PFN(exynos_gem_obj->phys_addr),
+				vma->vm_end - vma->vm_start,
+				vma->vm_page_prot);
 
 	if (unlikely(!attach)) {
 		pr_err("Invalid mmap with empty attach!\n");
@@ -18,9 +18,17 @@
 #include <drm/drm_device.h>
 #include <drm/drm_mode.h>
 #include <linux/dma-buf.h>
+#include <linux/mutex.h>
+#include <linux/shrinker.h>
+#include <linux/sizes.h>
+#include <linux/workqueue.h>
+
+struct dma_heap;
+struct seq_file;
 
 #define EXYNOS_DRM_GEM_FLAG_COLORMAP	BIT(0)
 #define EXYNOS_DRM_GEM_FLAG_DUMB_BUF	BIT(1)
+#define EXYNOS_DRM_GEM_FLAG_PHYS	BIT(2)
 
 struct exynos_drm_gem {
 	struct drm_gem_object base;
@@ -28,8 +36,82 @@ struct exynos_drm_gem {
 	dma_addr_t dma_addr;
 	void *vaddr;
 	unsigned int flags;
+
+	/* contiguous memory outside of dma-buf heaps, see FLAG_PHYS */
+	phys_addr_t phys_addr;
+	void (*release)(void *data);
+	void *release_data;
+};
+
+/*
+ * Dumb buffers are recycled through a size bucketed pool. Each entry keeps
+ * the dma-buf attachment, its mapped sg_table and the kernel mapping alive,
+ * so that a subsequent DUMB_CREATE of the same size skips the heap
+ * allocation and the IOMMU mapping entirely.
+ */
+#define EXYNOS_GEM_POOL_BUCKETS		16
+#define EXYNOS_GEM_POOL_DEFAULT_MAX	SZ_64M
+
+struct exynos_drm_gem_pool_stats {
+	u64 hits;
+	u64 misses;
+	u64 recycled;
+	u64 rejected;
+	u64 evicted;
+	u64 shrunk;
+};
+
+struct exynos_drm_gem_pool {
+	struct mutex lock;
+	struct dma_heap *heap;
+	struct list_head buckets[EXYNOS_GEM_POOL_BUCKETS];
+	struct list_head lru;
+	size_t cur_bytes;
+	size_t max_bytes;
+	bool disabled;
+	struct shrinker shrinker;
+	struct exynos_drm_gem_pool_stats stats;
 };
 
+/*
+ * Imports whose GEM object went away while the dma-buf is still held by
+ * somebody else keep their device mapping in an LRU cache keyed by dma-buf,
+ * so re-importing a recycled buffer does not map it into the IOMMU again.
+ * Entries are dropped on eviction, under memory pressure, or once every
+ * other holder released the buffer.
+ */
+#define EXYNOS_GEM_MAP_CACHE_DEFAULT_MAX	32
+
+struct exynos_drm_gem_map_cache_stats {
+	u64 hits;
+	u64 misses;
+	u64 inserted;
+	u64 evicted;
+	u64 reaped;
+	u64 shrunk;
+};
+
+struct exynos_drm_gem_map_cache {
+	struct mutex lock;
+	struct list_head lru;
+	u32 count;
+	u32 max_count;
+	size_t cur_bytes;
+	bool disabled;
+	struct shrinker shrinker;
+	struct delayed_work reap_work;
+	struct exynos_drm_gem_map_cache_stats stats;
+};
+
+int exynos_drm_gem_pool_init(struct exynos_drm_gem_pool *pool);
+void exynos_drm_gem_pool_fini(struct exynos_drm_gem_pool *pool);
+void exynos_drm_gem_pool_show(struct exynos_drm_gem_pool *pool,
+			      struct seq_file *s);
+int exynos_drm_gem_map_cache_init(struct exynos_drm_gem_map_cache *cache);
+void exynos_drm_gem_map_cache_fini(struct exynos_drm_gem_map_cache *cache);
+void exynos_drm_gem_map_cache_show(struct exynos_drm_gem_map_cache *cache,
+				   struct seq_file *s);
+
 int exynos_drm_gem_dumb_create(struct drm_file *file_priv,
 			       struct drm_device *dev,
 			       struct drm_mode_create_dumb *args);
@@ -40,12 +122,17 @@ int exynos_drm_gem_dumb_map_offset(struct drm_file *file_priv,
 void exynos_drm_gem_free_object(struct drm_gem_object *obj);
 struct exynos_drm_gem *exynos_drm_gem_alloc(struct drm_device *dev,
 					    size_t size, unsigned int flags);
+struct exynos_drm_gem *
+exynos_drm_gem_create_phys(struct drm_device *dev, phys_addr_t phys_addr,
+			   size_t size, void (*release)(void *data),
+			   void *release_data);
 struct drm_gem_object *
 exynos_drm_gem_prime_import_sg_table(struct drm_device *dev,
 				     struct dma_buf_attachment *attach,
 				     struct sg_table *sgt);
 struct drm_gem_object *exynos_drm_gem_prime_import(struct drm_device *dev,
 						   struct dma_buf *dma_buf);
+struct dma_buf *exynos_drm_gem_prime_export(struct drm_gem_object *obj, int flags);
 void *exynos_drm_gem_get_vaddr(struct exynos_drm_gem *exynos_gem_obj);
 struct drm_gem_object *exynos_drm_gem_fd_to_obj(struct drm_device *dev, int val);
 
@@ -20,6 +20,9 @@
 #include <linux/sched.h>
 #include <linux/err.h>
 #include <linux/atomic.h>
+#include <linux/input.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
 
 #include <trace/dpu_trace.h>
 
@@ -30,6 +33,13 @@
 #include "exynos_drm_writeback.h"
 
 #define HIBERNATION_ENTRY_MIN_TIME_MS		50
+#define HIBERNATION_ENTRY_DELAY_MIN_MS		10
+#define HIBERNATION_EXIT_COST_US		10000
+#define HIBERNATION_PRED_MIN_SAMPLES		8
+#define HIBERNATION_PRED_SAMPLE_WEIGHT		16
+#define HIBERNATION_PRED_MAX_TOTAL		2048
+#define HIBERNATION_PRED_MAX_INTERVAL_US	(10 * USEC_PER_SEC)
+#define HIBERNATION_INPUT_RATE_LIMIT_MS		100
 #define CAMERA_OPERATION_MASK	0xF
 
 static bool is_camera_operating(struct exynos_hibernation *hiber)
@@ -60,12 +70,353 @@ static inline bool is_dqe_dimming_in_progress(struct decon_device *decon)
 		dqe_reg_dimming_in_progress(decon->id));
 }
 
+/* upper bounds of exit latency histogram bins, last bin has no bound */
+static const u32 hibernation_exit_lat_bin_us[HIBERNATION_EXIT_LAT_BIN_CNT - 1] = {
+	500, 1000, 2000, 4000, 8000, 16000, 32000,
+};
+
+u32 exynos_hibernation_exit_lat_bin_us(unsigned int bin)
+{
+	if (bin >= ARRAY_SIZE(hibernation_exit_lat_bin_us))
+		return U32_MAX;
+
+	return hibernation_exit_lat_bin_us[bin];
+}
+
+/* account elapsed time to current state, stats lock must be held */
+static void hibernation_stats_advance(struct exynos_hibernation_stats *stats,
+			ktime_t now)
+{
+	const u64 delta = ktime_to_ns(ktime_sub(now, stats->last_update));
+
+	if (stats->active) {
+		if (stats->hibernated)
+			stats->hibernated_ns += delta;
+		else
+			stats->awake_ns += delta;
+	}
+
+	stats->last_update = now;
+}
+
+void exynos_hibernation_stats_power(struct exynos_hibernation *hiber, bool on)
+{
+	struct exynos_hibernation_stats *stats;
+	unsigned long flags;
+
+	if (!hiber)
+		return;
+
+	stats = &hiber->stats;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	hibernation_stats_advance(stats, ktime_get());
+	stats->active = on;
+	stats->hibernated = false;
+	stats->exit_start = 0;
+	spin_unlock_irqrestore(&stats->lock, flags);
+}
+
+void exynos_hibernation_stats_enter(struct exynos_hibernation *hiber)
+{
+	struct exynos_hibernation_stats *stats;
+	unsigned long flags;
+
+	if (!hiber)
+		return;
+
+	stats = &hiber->stats;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	hibernation_stats_advance(stats, ktime_get());
+	stats->hibernated = true;
+	stats->entry_cnt++;
+	spin_unlock_irqrestore(&stats->lock, flags);
+}
+
+void exynos_hibernation_stats_exit(struct exynos_hibernation *hiber)
+{
+	struct exynos_hibernation_stats *stats;
+	const ktime_t now = ktime_get();
+	unsigned long flags;
+
+	if (!hiber)
+		return;
+
+	stats = &hiber->stats;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	hibernation_stats_advance(stats, now);
+	stats->hibernated = false;
+	stats->exit_start = now;
+	stats->exit_cnt++;
+	spin_unlock_irqrestore(&stats->lock, flags);
+}
+
+void exynos_hibernation_stats_exit_done(struct exynos_hibernation *hiber)
+{
+	struct exynos_hibernation_stats *stats;
+	unsigned long flags;
+	unsigned int bin;
+	u32 lat_us;
+
+	if (!hiber)
+		return;
+
+	stats = &hiber->stats;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	if (!stats->exit_start) {
+		spin_unlock_irqrestore(&stats->lock, flags);
+		return;
+	}
+
+	lat_us = min_t(s64, ktime_us_delta(ktime_get(), stats->exit_start), U32_MAX);
+	stats->exit_start = 0;
+
+	for (bin = 0; bin < ARRAY_SIZE(hibernation_exit_lat_bin_us); bin++)
+		if (lat_us <= hibernation_exit_lat_bin_us[bin])
+			break;
+	stats->exit_lat_hist[bin]++;
+	stats->exit_lat_max_us = max(stats->exit_lat_max_us, lat_us);
+	spin_unlock_irqrestore(&stats->lock, flags);
+
+	trace_dpu_hibernation_exit_phase(hiber->decon->id, "total", lat_us);
+	pr_debug("%s: exit latency(%uus)\n", __func__, lat_us);
+}
+
+void exynos_hibernation_get_stats(struct exynos_hibernation *hiber,
+				  struct exynos_hibernation_stats *out)
+{
+	struct exynos_hibernation_stats *stats = &hiber->stats;
+	unsigned long flags;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	hibernation_stats_advance(stats, ktime_get());
+	/* copy counters only, lock stays with the live stats */
+	out->active = stats->active;
+	out->hibernated = stats->hibernated;
+	out->last_update = stats->last_update;
+	out->exit_start = stats->exit_start;
+	out->awake_ns = stats->awake_ns;
+	out->hibernated_ns = stats->hibernated_ns;
+	out->entry_cnt = stats->entry_cnt;
+	out->exit_cnt = stats->exit_cnt;
+	memcpy(out->exit_lat_hist, stats->exit_lat_hist, sizeof(out->exit_lat_hist));
+	out->exit_lat_max_us = stats->exit_lat_max_us;
+	memcpy(out->abort_cnt, stats->abort_cnt, sizeof(out->abort_cnt));
+	out->awake_mw = stats->awake_mw;
+	out->hibernated_mw = stats->hibernated_mw;
+	out->exit_uj = stats->exit_uj;
+	spin_unlock_irqrestore(&stats->lock, flags);
+}
+
+static void hibernation_stats_abort(struct exynos_hibernation *hiber,
+			enum exynos_hibernation_abort reason)
+{
+	struct exynos_hibernation_stats *stats = &hiber->stats;
+	unsigned long flags;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	stats->abort_cnt[reason]++;
+	spin_unlock_irqrestore(&stats->lock, flags);
+}
+
 static bool exynos_hibernation_check(struct exynos_hibernation *hiber)
 {
 	pr_debug("%s +\n", __func__);
 
-	return (!is_camera_operating(hiber) &&
-		!is_dqe_dimming_in_progress(hiber->decon));
+	if (is_camera_operating(hiber)) {
+		hibernation_stats_abort(hiber, HIBERNATION_ABORT_CAMERA);
+		return false;
+	}
+
+	if (is_dqe_dimming_in_progress(hiber->decon)) {
+		hibernation_stats_abort(hiber, HIBERNATION_ABORT_DQE_DIMMING);
+		return false;
+	}
+
+	return true;
+}
+
+/* upper bounds of inter-commit interval histogram bins, last bin has no bound */
+static const u32 hibernation_pred_bin_ms[HIBERNATION_PRED_BIN_CNT - 1] = {
+	10, 20, 34, 50, 67, 100, 200, 500, 1000, 2000,
+};
+
+u32 exynos_hibernation_pred_bin_ms(unsigned int bin)
+{
+	if (bin >= ARRAY_SIZE(hibernation_pred_bin_ms))
+		return U32_MAX;
+
+	return hibernation_pred_bin_ms[bin];
+}
+
+static u64 hibernation_pred_bin_interval_us(const struct exynos_hibernation_pred *pred,
+			unsigned int bin)
+{
+	const u64 lo_us = bin ? hibernation_pred_bin_ms[bin - 1] * USEC_PER_MSEC : 0;
+
+	/* there is no upper bound for last bin, long term average is used instead */
+	if (bin == ARRAY_SIZE(hibernation_pred_bin_ms))
+		return max_t(u64, lo_us * 2,
+			     ewma_hiber_interval_read(&pred->interval));
+
+	return (lo_us + hibernation_pred_bin_ms[bin] * USEC_PER_MSEC) / 2;
+}
+
+static void hibernation_pred_add_sample(struct exynos_hibernation_pred *pred,
+			u64 interval_us)
+{
+	unsigned int bin;
+
+	interval_us = min_t(u64, interval_us, HIBERNATION_PRED_MAX_INTERVAL_US);
+	ewma_hiber_interval_add(&pred->interval, interval_us);
+
+	for (bin = 0; bin < ARRAY_SIZE(hibernation_pred_bin_ms); bin++)
+		if (interval_us <= hibernation_pred_bin_ms[bin] * USEC_PER_MSEC)
+			break;
+
+	pred->hist[bin] += HIBERNATION_PRED_SAMPLE_WEIGHT;
+	pred->hist_total += HIBERNATION_PRED_SAMPLE_WEIGHT;
+	pred->samples++;
+
+	/* decay older samples so that predictor follows changes of cadence */
+	if (pred->hist_total > HIBERNATION_PRED_MAX_TOTAL) {
+		pred->hist_total = 0;
+		for (bin = 0; bin < HIBERNATION_PRED_BIN_CNT; bin++) {
+			pred->hist[bin] >>= 1;
+			pred->hist_total += pred->hist[bin];
+		}
+	}
+}
+
+/*
+ * Choose entry delay which maximizes expected hibernation residency minus exit
+ * cost over the interval histogram. Next commit arriving before the delay
+ * expires doesn't cost anything, otherwise residency is the remaining time of
+ * the interval. The optimum is always at one of the bin bounds, and among equal
+ * gains the delay with fewer expected entries wins.
+ */
+static u32 hibernation_pred_choose_delay(const struct exynos_hibernation_pred *pred)
+{
+	s64 best_gain = 0;
+	u32 best_entries = 0, best_ms = 0;
+	unsigned int c, bin;
+
+	if (pred->samples < HIBERNATION_PRED_MIN_SAMPLES)
+		return HIBERNATION_ENTRY_MIN_TIME_MS;
+
+	for (c = 0; c <= ARRAY_SIZE(hibernation_pred_bin_ms); c++) {
+		const u32 delay_ms = c ? hibernation_pred_bin_ms[c - 1] :
+					HIBERNATION_ENTRY_DELAY_MIN_MS;
+		const s64 delay_us = delay_ms * USEC_PER_MSEC;
+		u32 entries = 0;
+		s64 gain = 0;
+
+		for (bin = 0; bin < HIBERNATION_PRED_BIN_CNT; bin++) {
+			const s64 interval_us = hibernation_pred_bin_interval_us(pred, bin);
+
+			if (!pred->hist[bin] || interval_us <= delay_us)
+				continue;
+
+			gain += (s64)pred->hist[bin] *
+				(interval_us - delay_us - pred->exit_cost_us);
+			entries += pred->hist[bin];
+		}
+
+		if (!best_ms || gain > best_gain ||
+				(gain == best_gain && entries < best_entries)) {
+			best_gain = gain;
+			best_entries = entries;
+			best_ms = delay_ms;
+		}
+	}
+
+	return best_ms;
+}
+
+static void hibernation_input_record_commit(struct exynos_hibernation_input *input,
+			bool exited)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&input->lock, flags);
+	if (input->pending) {
+		if (exited)
+			input->misses++;
+		else
+			input->hits++;
+		input->pending = false;
+	}
+	spin_unlock_irqrestore(&input->lock, flags);
+}
+
+void exynos_hibernation_record_commit(struct exynos_hibernation *hiber, bool exited)
+{
+	struct exynos_hibernation_pred *pred;
+	const ktime_t now = ktime_get();
+	unsigned long flags;
+
+	if (!hiber)
+		return;
+
+	hibernation_input_record_commit(&hiber->input, exited);
+
+	pred = &hiber->pred;
+
+	spin_lock_irqsave(&pred->lock, flags);
+
+	if (pred->enter_ts) {
+		if (ktime_us_delta(now, pred->enter_ts) >= pred->exit_cost_us)
+			pred->hits++;
+		else
+			pred->misses++;
+		pred->enter_ts = 0;
+	}
+
+	if (pred->last_commit) {
+		hibernation_pred_add_sample(pred, ktime_us_delta(now, pred->last_commit));
+		pred->delay_ms = hibernation_pred_choose_delay(pred);
+		pred->decisions++;
+	}
+	pred->last_commit = now;
+
+	spin_unlock_irqrestore(&pred->lock, flags);
+
+	pr_debug("%s: entry delay(%ums)\n", __func__, pred->delay_ms);
+}
+
+static void hibernation_pred_record_enter(struct exynos_hibernation *hiber)
+{
+	struct exynos_hibernation_pred *pred = &hiber->pred;
+	struct exynos_hibernation_input *input = &hiber->input;
+	unsigned long flags;
+
+	spin_lock_irqsave(&pred->lock, flags);
+	if (!pred->enter_ts)
+		pred->enter_ts = ktime_get();
+	spin_unlock_irqrestore(&pred->lock, flags);
+
+	spin_lock_irqsave(&input->lock, flags);
+	if (input->pending) {
+		input->unused++;
+		input->pending = false;
+	}
+	spin_unlock_irqrestore(&input->lock, flags);
+}
+
+static void hibernation_pred_init(struct exynos_hibernation_pred *pred)
+{
+	spin_lock_init(&pred->lock);
+	ewma_hiber_interval_init(&pred->interval);
+	pred->exit_cost_us = HIBERNATION_EXIT_COST_US;
+	pred->delay_ms = HIBERNATION_ENTRY_MIN_TIME_MS;
+}
+
+static inline unsigned long hibernation_entry_delay(struct exynos_hibernation *hiber)
+{
+	return msecs_to_jiffies(READ_ONCE(hiber->pred.delay_ms));
 }
 
 static inline void hibernation_unblock(struct exynos_hibernation *hiber)
@@ -273,7 +624,7 @@ void hibernation_unblock_enter(struct exynos_hibernation *hiber)
 
 	if (!is_hibernaton_blocked(hiber))
 		kthread_mod_delayed_work(&hiber->decon->worker, &hiber->dwork,
-			msecs_to_jiffies(HIBERNATION_ENTRY_MIN_TIME_MS));
+			hibernation_entry_delay(hiber));
 
 	pr_debug("%s: block_cnt(%d)\n", __func__, atomic_read(&hiber->block_cnt));
 }
@@ -304,8 +655,12 @@ static int _exynos_hibernation_run(struct exynos_hibernation *hibernation, bool
 	pr_debug("%s: decon state: %d +\n", __func__, decon->state);
 
 	if (is_hibernaton_blocked(hibernation)) {
-		if (decon->state == DECON_STATE_ON)
+		if (decon->state == DECON_STATE_ON) {
 			rc = -EBUSY;
+			if (atomic_read(&hibernation->block_cnt) > 0)
+				hibernation_stats_abort(hibernation,
+						HIBERNATION_ABORT_BLOCKED);
+		}
 		goto ret;
 	}
 
@@ -318,6 +673,10 @@ static int _exynos_hibernation_run(struct exynos_hibernation *hibernation, bool
 	hibernation_block(hibernation);
 	rc = funcs->enter(hibernation, nonblock);
 	hibernation_unblock(hibernation);
+
+	/* normal commit is pending */
+	if (rc == -EBUSY)
+		hibernation_stats_abort(hibernation, HIBERNATION_ABORT_COMMIT);
 ret:
 	mutex_unlock(&hibernation->lock);
 
@@ -335,9 +694,173 @@ static void exynos_hibernation_handler(struct kthread_work *work)
 	pr_debug("Display hibernation handler is called\n");
 
 	rc = _exynos_hibernation_run(hibernation, true);
-	if (rc == -EAGAIN)
+	if (!rc)
+		hibernation_pred_record_enter(hibernation);
+	else if (rc == -EAGAIN)
 		kthread_mod_delayed_work(&hibernation->decon->worker, &hibernation->dwork,
-			msecs_to_jiffies(HIBERNATION_ENTRY_MIN_TIME_MS));
+			hibernation_entry_delay(hibernation));
+}
+
+static void hibernation_input_work(struct work_struct *work)
+{
+	struct exynos_hibernation_input *input = container_of(work,
+			struct exynos_hibernation_input, work);
+	struct exynos_hibernation *hiber = container_of(input,
+			struct exynos_hibernation, input);
+	unsigned long flags;
+
+	DPU_ATRACE_BEGIN(__func__);
+	if (exynos_hibernation_async_exit(hiber)) {
+		spin_lock_irqsave(&input->lock, flags);
+		input->exits++;
+		input->pending = true;
+		spin_unlock_irqrestore(&input->lock, flags);
+	}
+	DPU_ATRACE_END(__func__);
+}
+
+static bool hibernation_input_match(const struct exynos_hibernation_input *input,
+			unsigned int type, unsigned int code, int value)
+{
+	if (type >= BITS_PER_TYPE(input->ev_mask) || !(input->ev_mask & BIT(type)))
+		return false;
+
+	switch (type) {
+	case EV_KEY:
+		/* key press only, release or autorepeat follow anyway */
+		return value == 1;
+	case EV_ABS:
+		/* new touch contact */
+		return code == ABS_MT_TRACKING_ID && value >= 0;
+	default:
+		return true;
+	}
+}
+
+static void hibernation_input_event(struct input_handle *handle,
+			unsigned int type, unsigned int code, int value)
+{
+	struct exynos_hibernation *hiber = handle->handler->private;
+	struct exynos_hibernation_input *input = &hiber->input;
+	const unsigned long now = jiffies;
+	unsigned long flags;
+
+	if (!is_hibernation_enabled(hiber) ||
+			!hibernation_input_match(input, type, code, value))
+		return;
+
+	spin_lock_irqsave(&input->lock, flags);
+	if (time_before(now, input->next_allowed)) {
+		input->rate_limited++;
+		spin_unlock_irqrestore(&input->lock, flags);
+		return;
+	}
+	input->next_allowed = now + msecs_to_jiffies(input->rate_limit_ms);
+	input->events++;
+	spin_unlock_irqrestore(&input->lock, flags);
+
+	queue_work(system_highpri_wq, &input->work);
+}
+
+static int hibernation_input_connect(struct input_handler *handler,
+			struct input_dev *dev, const struct input_device_id *id)
+{
+	struct input_handle *handle;
+	int ret;
+
+	handle = kzalloc(sizeof(*handle), GFP_KERNEL);
+	if (!handle)
+		return -ENOMEM;
+
+	handle->dev = dev;
+	handle->handler = handler;
+	handle->name = handler->name;
+
+	ret = input_register_handle(handle);
+	if (ret)
+		goto err_register;
+
+	ret = input_open_device(handle);
+	if (ret)
+		goto err_open;
+
+	pr_debug("%s: %s connected\n", handler->name, dev->name);
+
+	return 0;
+
+err_open:
+	input_unregister_handle(handle);
+err_register:
+	kfree(handle);
+	return ret;
+}
+
+static void hibernation_input_disconnect(struct input_handle *handle)
+{
+	input_close_device(handle);
+	input_unregister_handle(handle);
+	kfree(handle);
+}
+
+static const struct input_device_id hibernation_input_ids[] = {
+	/* multi-touch touchscreen */
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_EVBIT |
+			 INPUT_DEVICE_ID_MATCH_ABSBIT,
+		.evbit = { BIT_MASK(EV_ABS) },
+		.absbit = { [BIT_WORD(ABS_MT_POSITION_X)] =
+			    BIT_MASK(ABS_MT_POSITION_X) |
+			    BIT_MASK(ABS_MT_POSITION_Y) },
+	},
+	/* keys, e.g. power and volume keys */
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_EVBIT,
+		.evbit = { BIT_MASK(EV_KEY) },
+	},
+	{ },
+};
+
+static void hibernation_input_register(struct exynos_hibernation *hiber)
+{
+	struct exynos_hibernation_input *input = &hiber->input;
+	int ret;
+
+	spin_lock_init(&input->lock);
+	INIT_WORK(&input->work, hibernation_input_work);
+	input->ev_mask = BIT(EV_KEY) | BIT(EV_ABS);
+	input->rate_limit_ms = HIBERNATION_INPUT_RATE_LIMIT_MS;
+
+	if (!of_property_read_bool(hiber->decon->dev->of_node,
+				"hibernation-input-exit"))
+		return;
+
+	input->handler.event = hibernation_input_event;
+	input->handler.connect = hibernation_input_connect;
+	input->handler.disconnect = hibernation_input_disconnect;
+	input->handler.name = dev_name(hiber->decon->dev);
+	input->handler.id_table = hibernation_input_ids;
+	input->handler.private = hiber;
+
+	ret = input_register_handler(&input->handler);
+	if (ret) {
+		pr_warn("failed to register hibernation input handler(%d)\n", ret);
+		return;
+	}
+
+	input->registered = true;
+	pr_info("display hibernation exits on input\n");
+}
+
+static void hibernation_input_unregister(struct exynos_hibernation *hiber)
+{
+	struct exynos_hibernation_input *input = &hiber->input;
+
+	if (!input->registered)
+		return;
+
+	input_unregister_handler(&input->handler);
+	cancel_work_sync(&input->work);
+	input->registered = false;
 }
 
 int exynos_hibernation_suspend(struct exynos_hibernation *hiber)
@@ -399,8 +922,14 @@ exynos_hibernation_register(struct decon_device *decon)
 
 	atomic_set(&hibernation->block_cnt, 0);
 
+	hibernation_pred_init(&hibernation->pred);
+	spin_lock_init(&hibernation->stats.lock);
+	hibernation->stats.last_update = ktime_get();
+
 	kthread_init_delayed_work(&hibernation->dwork, exynos_hibernation_handler);
 
+	hibernation_input_register(hibernation);
+
 	pr_info("display hibernation is supported\n");
 
 	return hibernation;
@@ -408,6 +937,11 @@ exynos_hibernation_register(struct decon_device *decon)
 
 void exynos_hibernation_destroy(struct exynos_hibernation *hiber)
 {
+	if (!hiber)
+		return;
+
+	hibernation_input_unregister(hiber);
+
 	if (!is_hibernation_enabled(hiber))
 		return;
 
@@ -20,6 +20,11 @@
 #include <linux/sched.h>
 #include <linux/kthread.h>
 #include <linux/io.h>
+#include <linux/average.h>
+#include <linux/spinlock.h>
+#include <linux/ktime.h>
+#include <linux/input.h>
+#include <linux/workqueue.h>
 
 struct decon_device;
 struct dsim_device;
@@ -33,6 +38,122 @@ struct exynos_hibernation_funcs {
 	bool (*check)(struct exynos_hibernation *hiber);
 };
 
+/* EWMA of inter-commit interval in us, 1/8 weight on new samples */
+DECLARE_EWMA(hiber_interval, 4, 8)
+
+#define HIBERNATION_PRED_BIN_CNT	11
+
+/**
+ * struct exynos_hibernation_pred - predictor of hibernation entry delay
+ * @lock: protects all fields below
+ * @last_commit: timestamp of last (non self-refresh) commit
+ * @enter_ts: timestamp of last hibernation entry, zero if not hibernated since
+ *	last commit
+ * @interval: EWMA of inter-commit interval
+ * @hist: decaying histogram of inter-commit interval
+ * @hist_total: sum of all histogram bins
+ * @samples: number of intervals recorded
+ * @exit_cost_us: break-even residency of hibernation entry and exit
+ * @delay_ms: currently chosen hibernation entry delay
+ * @decisions: number of times entry delay was chosen
+ * @hits: hibernation entries which lasted longer than exit cost
+ * @misses: hibernation entries which were exited before exit cost is paid
+ */
+struct exynos_hibernation_pred {
+	spinlock_t lock;
+	ktime_t last_commit;
+	ktime_t enter_ts;
+	struct ewma_hiber_interval interval;
+	u32 hist[HIBERNATION_PRED_BIN_CNT];
+	u32 hist_total;
+	u32 samples;
+	u32 exit_cost_us;
+	u32 delay_ms;
+	u32 decisions;
+	u32 hits;
+	u32 misses;
+};
+
+/**
+ * struct exynos_hibernation_input - input driven early hibernation exit
+ * @handler: input handler bound to touchscreen and key devices
+ * @work: exits hibernation out of input event context
+ * @lock: protects rate limit and stats below
+ * @registered: whether @handler is registered
+ * @ev_mask: bitmask of input event types (EV_*) which trigger exit
+ * @rate_limit_ms: minimum time between two triggered exits
+ * @next_allowed: jiffies before which events are rate limited
+ * @pending: hibernation was exited by input and no commit arrived yet
+ * @events: input events which triggered exit
+ * @rate_limited: input events dropped by rate limit
+ * @exits: triggered exits while hibernation was on
+ * @hits: next commit found display already out of hibernation
+ * @misses: next commit had to exit hibernation itself
+ * @unused: hibernation was entered again before any commit
+ */
+struct exynos_hibernation_input {
+	struct input_handler handler;
+	struct work_struct work;
+	spinlock_t lock;
+	bool registered;
+	u32 ev_mask;
+	u32 rate_limit_ms;
+	unsigned long next_allowed;
+	bool pending;
+	u32 events;
+	u32 rate_limited;
+	u32 exits;
+	u32 hits;
+	u32 misses;
+	u32 unused;
+};
+
+enum exynos_hibernation_abort {
+	HIBERNATION_ABORT_BLOCKED,
+	HIBERNATION_ABORT_CAMERA,
+	HIBERNATION_ABORT_DQE_DIMMING,
+	HIBERNATION_ABORT_COMMIT,
+	HIBERNATION_ABORT_MAX,
+};
+
+#define HIBERNATION_EXIT_LAT_BIN_CNT	8
+
+/**
+ * struct exynos_hibernation_stats - hibernation residency and latency accounting
+ * @lock: protects all fields below
+ * @active: display is powered on, either awake or hibernated
+ * @hibernated: display is in hibernation
+ * @last_update: timestamp when time below was last accounted
+ * @exit_start: timestamp when ongoing hibernation exit started, zero if none
+ * @awake_ns: cumulative time awake
+ * @hibernated_ns: cumulative time in hibernation
+ * @entry_cnt: number of hibernation entries
+ * @exit_cnt: number of hibernation exits
+ * @exit_lat_hist: histogram of hibernation exit latency
+ * @exit_lat_max_us: worst hibernation exit latency
+ * @abort_cnt: aborted hibernation entries per reason
+ * @awake_mw: estimated power while awake
+ * @hibernated_mw: estimated power while hibernated
+ * @exit_uj: estimated energy of one hibernation exit
+ */
+struct exynos_hibernation_stats {
+	spinlock_t lock;
+	bool active;
+	bool hibernated;
+	ktime_t last_update;
+	ktime_t exit_start;
+	u64 awake_ns;
+	u64 hibernated_ns;
+	u32 entry_cnt;
+	u32 exit_cnt;
+	u32 exit_lat_hist[HIBERNATION_EXIT_LAT_BIN_CNT];
+	u32 exit_lat_max_us;
+	u32 abort_cnt[HIBERNATION_ABORT_MAX];
+	u32 awake_mw;
+	u32 hibernated_mw;
+	u32 exit_uj;
+};
+
 struct exynos_hibernation {
 	atomic_t block_cnt;
 	/* register to check whether camera is operating or not */
@@ -43,6 +164,9 @@ struct exynos_hibernation {
 	struct dsim_device *dsim;
 	struct writeback_device *wb;
 	const struct exynos_hibernation_funcs *funcs;
+	struct exynos_hibernation_pred pred;
+	struct exynos_hibernation_input input;
+	struct exynos_hibernation_stats stats;
 	bool enabled;
 };
 
@@ -82,6 +206,63 @@ void hibernation_unblock_enter(struct exynos_hibernation *hiber);
  */
 bool exynos_hibernation_async_exit(struct exynos_hibernation *hiber);
 
+/**
+ * exynos_hibernation_record_commit - feed a commit into hibernation entry delay predictor
+ * @hiber: hibernation block ptr
+ * @exited: whether the commit itself exits hibernation
+ */
+void exynos_hibernation_record_commit(struct exynos_hibernation *hiber, bool exited);
+
+/**
+ * exynos_hibernation_stats_power - account display power on or off
+ * @hiber: hibernation block ptr
+ * @on: whether display is powered on
+ */
+void exynos_hibernation_stats_power(struct exynos_hibernation *hiber, bool on);
+
+/**
+ * exynos_hibernation_stats_enter - account hibernation entry
+ * @hiber: hibernation block ptr
+ */
+void exynos_hibernation_stats_enter(struct exynos_hibernation *hiber);
+
+/**
+ * exynos_hibernation_stats_exit - account start of hibernation exit
+ * @hiber: hibernation block ptr
+ */
+void exynos_hibernation_stats_exit(struct exynos_hibernation *hiber);
+
+/**
+ * exynos_hibernation_stats_exit_done - account end of hibernation exit, once
+ *	the whole display pipeline is enabled again
+ * @hiber: hibernation block ptr
+ */
+void exynos_hibernation_stats_exit_done(struct exynos_hibernation *hiber);
+
+/**
+ * exynos_hibernation_get_stats - get snapshot of hibernation stats
+ * @hiber: hibernation block ptr
+ * @stats: snapshot, with time accounted up to now
+ */
+void exynos_hibernation_get_stats(struct exynos_hibernation *hiber,
+				  struct exynos_hibernation_stats *stats);
+
+/**
+ * exynos_hibernation_exit_lat_bin_us - upper bound of exit latency histogram bin
+ * @bin: bin index
+ *
+ * Return: upper bound in us, U32_MAX for the last bin
+ */
+u32 exynos_hibernation_exit_lat_bin_us(unsigned int bin);
+
+/**
+ * exynos_hibernation_pred_bin_ms - upper bound of predictor histogram bin
+ * @bin: bin index
+ *
+ * Return: upper bound in ms, U32_MAX for the last bin
+ */
+u32 exynos_hibernation_pred_bin_ms(unsigned int bin);
+
 struct exynos_hibernation *
 exynos_hibernation_register(struct decon_device *decon);
 void exynos_hibernation_destroy(struct exynos_hibernation *hiber);
@@ -13,6 +13,7 @@
 #include <linux/device.h>
 #include <linux/of.h>
 #include <video/mipi_display.h>
+#include <drm/drm_damage_helper.h>
 #include <drm/drm_fourcc.h>
 #include "exynos_drm_decon.h"
 #include "exynos_drm_format.h"
@@ -23,6 +24,16 @@
 #define pr_region(str, r)	\
 	pr_debug("%s["DRM_RECT_FMT"]\n", (str), DRM_RECT_ARG(r))
 
+/*
+ * Partial update cost model, all costs are in units of transferred lines.
+ * DPP reconfiguration cost is charged for each plane cropped by the region,
+ * partial command cost is charged when a new CASET/PASET has to be sent.
+ */
+#define PARTIAL_DPP_RECONFIG_COST_LINES		8
+#define PARTIAL_COMMAND_COST_LINES		2
+/* partial update must save at least this much compared with full update */
+#define PARTIAL_MIN_SAVING_PCT			10
+
 static int exynos_partial_init(struct exynos_partial *partial,
 		const struct exynos_display_partial *partial_mode,
 		const struct drm_display_mode *mode)
@@ -123,51 +134,103 @@ exynos_plane_state_scaling(const struct drm_plane_state *state)
 		(state->src_h >> 16 != state->crtc_h);
 }
 
+/*
+ * Back-project the part of plane which is kept by clip rectangle into source
+ * coordinates. It's the same transform as drm_atomic_helper_check_plane_state()
+ * does for crtc clipping, including rotation and scaling. The unclipped user
+ * coordinates are used, so it can be called before planes are checked.
+ */
+static bool exynos_partial_project(const struct drm_plane_state *state,
+			const struct drm_rect *clip, struct drm_rect *src,
+			struct drm_rect *dst)
+{
+	const struct drm_framebuffer *fb = state->fb;
+	bool visible;
+
+	*src = drm_plane_state_src(state);
+	*dst = drm_plane_state_dest(state);
+
+	drm_rect_rotate(src, fb->width << 16, fb->height << 16, state->rotation);
+	visible = drm_rect_clip_scaled(src, dst, clip);
+	drm_rect_rotate_inv(src, fb->width << 16, fb->height << 16,
+			state->rotation);
+
+	return visible;
+}
+
 static bool is_partial_supported(const struct drm_plane_state *state,
-		const struct drm_rect *crtc_r, const struct drm_rect *partial_r,
+		const struct drm_display_mode *mode, const struct drm_rect *partial_r,
 		const struct dpp_restriction *res)
 {
 	const struct dpu_fmt *fmt_info;
-	unsigned int adj_src_x = 0, adj_src_y = 0;
-	u32 format;
-	int sz_align = 1;
+	struct drm_rect src, dst, full_src, full_dst, full_r;
+	const bool rotation = exynos_plane_state_rotation(state);
+	u32 src_x, src_y, src_w, src_h, dst_w, dst_h;
+	u32 sz_align = 1;
 
-	if (exynos_plane_state_rotation(state)) {
-		pr_debug("rotation is detected. partial->full\n");
-		goto not_supported;
-	}
+	if (!exynos_partial_project(state, partial_r, &src, &dst))
+		return true;
+
+	/* plane isn't cropped by update region, it's just translated */
+	exynos_partial_set_full(mode, &full_r);
+	exynos_partial_project(state, &full_r, &full_src, &full_dst);
+	if (drm_rect_equals(&dst, &full_dst))
+		return true;
 
-	if (exynos_plane_state_scaling(state)) {
-		pr_debug("scaling is detected. partial->full\n");
+	/*
+	 * Initial phase of scaler isn't programmable, it always starts on
+	 * the first source pixel. Crop edges of scaled plane should land on
+	 * whole source pixels, otherwise the cropped part is shifted against
+	 * the area that is not updated.
+	 */
+	if (exynos_plane_state_scaling(state) &&
+			(((src.x1 != full_src.x1) && (src.x1 & 0xffff)) ||
+			 ((src.y1 != full_src.y1) && (src.y1 & 0xffff)) ||
+			 ((src.x2 != full_src.x2) && (src.x2 & 0xffff)) ||
+			 ((src.y2 != full_src.y2) && (src.y2 & 0xffff)))) {
+		pr_debug("sub-pixel crop on scaled plane. partial->full\n");
 		goto not_supported;
 	}
 
-	format = state->fb->format->format;
-	fmt_info = dpu_find_fmt_info(format);
-	if (IS_YUV(fmt_info)) {
-		adj_src_x = state->src_x >> 16;
-		adj_src_y = state->src_y >> 16;
-		sz_align = 2;
+	src_x = src.x1 >> 16;
+	src_y = src.y1 >> 16;
+	src_w = drm_rect_width(&src) >> 16;
+	src_h = drm_rect_height(&src) >> 16;
+	dst_w = drm_rect_width(&dst);
+	dst_h = drm_rect_height(&dst);
 
-		if (partial_r->x1 > state->crtc_x)
-			adj_src_x += partial_r->x1 - state->crtc_x;
+	fmt_info = dpu_find_fmt_info(state->fb->format->format);
+	/* YUV format must be aligned to 2, rotation is only for YUV420 */
+	if (IS_YUV(fmt_info))
+		sz_align = 2;
 
-		if (partial_r->y1 > state->crtc_y)
-			adj_src_y += partial_r->y1 - state->crtc_y;
+	if (!IS_ALIGNED(src_x, res->src_x_align * sz_align) ||
+			!IS_ALIGNED(src_y, res->src_y_align * sz_align) ||
+			!IS_ALIGNED(src_w, res->src_w.align * sz_align) ||
+			!IS_ALIGNED(src_h, res->src_h.align * sz_align)) {
+		pr_debug("align limitation. src[%d %d %d %d] align[%d] rot[%d]\n",
+				src_x, src_y, src_w, src_h, sz_align, rotation);
+		goto not_supported;
+	}
 
-		/* YUV format must be aligned to 2 */
-		if (!IS_ALIGNED(adj_src_x, sz_align) ||
-				!IS_ALIGNED(adj_src_y, sz_align)) {
-			pr_debug("align limitation. src_x/y[%d/%d] align[%d]\n",
-					adj_src_x, adj_src_y, sz_align);
-			goto not_supported;
-		}
+	if ((src_w < res->src_w.min * sz_align) ||
+			(src_h < res->src_h.min * sz_align) ||
+			(dst_w < res->dst_w.min) || (dst_h < res->dst_h.min)) {
+		pr_debug("min size limitation. src[%dx%d] dst[%dx%d]\n",
+				src_w, src_h, dst_w, dst_h);
+		goto not_supported;
 	}
 
-	if ((drm_rect_width(crtc_r) < res->src_f_w.min * sz_align) ||
-			(drm_rect_height(crtc_r) < res->src_f_h.min * sz_align)) {
-		pr_debug("min size limitation. width[%d] height[%d]\n",
-				drm_rect_width(crtc_r), drm_rect_height(crtc_r));
+	/* truncated source size shouldn't break scaling ratio limitation */
+	if (rotation)
+		swap(src_w, src_h);
+
+	if ((src_w > dst_w * res->scale_down) ||
+			(src_h > dst_h * res->scale_down) ||
+			(src_w * res->scale_up < dst_w) ||
+			(src_h * res->scale_up < dst_h)) {
+		pr_debug("scale limitation. src[%dx%d] dst[%dx%d]\n",
+				src_w, src_h, dst_w, dst_h);
 		goto not_supported;
 	}
 
@@ -204,13 +267,62 @@ static bool exynos_partial_check(struct exynos_partial *partial,
 		res = &dpp->restriction;
 		pr_debug("checking plane%d ...\n", drm_plane_index(plane));
 
-		if (!is_partial_supported(plane_state, &r, partial_r, res))
+		if (!is_partial_supported(plane_state, &crtc_state->mode,
+					partial_r, res))
 			return false;
 	}
 
 	return true;
 }
 
+static bool exynos_partial_is_cost_effective(struct exynos_partial *partial,
+			struct exynos_drm_crtc_state *exynos_crtc_state,
+			const struct drm_rect *old_partial_r)
+{
+	struct drm_crtc_state *crtc_state = &exynos_crtc_state->base;
+	const struct drm_display_mode *mode = &crtc_state->mode;
+	const struct drm_rect *partial_r = &exynos_crtc_state->partial_region;
+	const struct decon_device *decon = partial->decon;
+	struct drm_plane *plane;
+	const struct drm_plane_state *plane_state;
+	u32 full_cost = mode->vdisplay;
+	u32 partial_cost, lines;
+	u32 reconfig_cnt = 0;
+
+	lines = drm_rect_height(partial_r);
+
+	/* compressed transfer is done in units of slices */
+	if (decon && decon->config.dsc.enabled && decon->config.dsc.slice_height)
+		lines = min_t(u32, roundup(lines, decon->config.dsc.slice_height),
+				mode->vdisplay);
+
+	drm_for_each_plane_mask(plane, crtc_state->state->dev, crtc_state->plane_mask) {
+		struct drm_rect dst, r;
+
+		plane_state = drm_atomic_get_plane_state(crtc_state->state, plane);
+		if (IS_ERR(plane_state))
+			return false;
+
+		dst = drm_plane_state_dest(plane_state);
+		r = dst;
+		if (!drm_rect_intersect(&r, partial_r))
+			continue;
+
+		/* planes cropped by update region need to reconfigure DPP */
+		if (!drm_rect_equals(&r, &dst))
+			reconfig_cnt++;
+	}
+
+	partial_cost = lines + reconfig_cnt * PARTIAL_DPP_RECONFIG_COST_LINES;
+	if (!drm_rect_equals(partial_r, old_partial_r))
+		partial_cost += PARTIAL_COMMAND_COST_LINES;
+
+	pr_debug("cost: partial(%u: lines %u reconfig %u) full(%u)\n",
+			partial_cost, lines, reconfig_cnt, full_cost);
+
+	return partial_cost * 100 < full_cost * (100 - PARTIAL_MIN_SAVING_PCT);
+}
+
 static int exynos_partial_send_command(struct exynos_partial *partial,
 					const struct drm_rect *partial_r)
 {
@@ -308,6 +420,7 @@ static void exynos_partial_set_size(struct exynos_partial *partial,
 static const struct exynos_partial_funcs partial_funcs = {
 	.init			 = exynos_partial_init,
 	.check			 = exynos_partial_check,
+	.is_cost_effective	 = exynos_partial_is_cost_effective,
 	.adjust_partial_region	 = exynos_partial_adjust_region,
 	.send_partial_command	 = exynos_partial_send_command,
 	.set_partial_size	 = exynos_partial_set_size,
@@ -373,6 +486,200 @@ exynos_partial_is_full(const struct drm_display_mode *mode, const struct drm_rec
 	return drm_rect_equals(&full, rect);
 }
 
+/*
+ * Merge all damage rectangles requested in partial region blob into a single
+ * update band. DECON transfers one region per frame, so the band has to cover
+ * every damaged line.
+ */
+static int exynos_partial_merge_region(const struct drm_property_blob *blob,
+			struct drm_rect *req)
+{
+	const struct drm_clip_rect *rects = blob->data;
+	const size_t cnt = blob->length / sizeof(*rects);
+	size_t i;
+
+	if (!cnt || cnt > EXYNOS_PARTIAL_MAX_RECTS) {
+		pr_debug("changed full: %zu damage rects requested\n", cnt);
+		return -EINVAL;
+	}
+
+	req->x1 = rects[0].x1;
+	req->y1 = rects[0].y1;
+	req->x2 = rects[0].x2;
+	req->y2 = rects[0].y2;
+
+	for (i = 1; i < cnt; i++) {
+		/* ignore empty rects, those don't carry any damage */
+		if (rects[i].x1 >= rects[i].x2 || rects[i].y1 >= rects[i].y2)
+			continue;
+
+		if (!drm_rect_visible(req)) {
+			req->x1 = rects[i].x1;
+			req->y1 = rects[i].y1;
+			req->x2 = rects[i].x2;
+			req->y2 = rects[i].y2;
+			continue;
+		}
+
+		req->x1 = min_t(int, req->x1, rects[i].x1);
+		req->y1 = min_t(int, req->y1, rects[i].y1);
+		req->x2 = max_t(int, req->x2, rects[i].x2);
+		req->y2 = max_t(int, req->y2, rects[i].y2);
+	}
+
+	if (cnt > 1)
+		pr_region("merged damage region", req);
+
+	return 0;
+}
+
+static void exynos_partial_add_damage(struct drm_rect *damage, const struct drm_rect *r)
+{
+	if (!drm_rect_visible(r))
+		return;
+
+	if (!drm_rect_visible(damage)) {
+		*damage = *r;
+		return;
+	}
+
+	damage->x1 = min(damage->x1, r->x1);
+	damage->y1 = min(damage->y1, r->y1);
+	damage->x2 = max(damage->x2, r->x2);
+	damage->y2 = max(damage->y2, r->y2);
+}
+
+static bool exynos_plane_state_props_changed(const struct drm_plane_state *old_state,
+			const struct drm_plane_state *new_state)
+{
+	const struct exynos_drm_plane_state *old_exynos_state =
+					to_exynos_plane_state(old_state);
+	const struct exynos_drm_plane_state *new_exynos_state =
+					to_exynos_plane_state(new_state);
+
+	return (old_state->alpha != new_state->alpha) ||
+		(old_state->pixel_blend_mode != new_state->pixel_blend_mode) ||
+		(old_state->rotation != new_state->rotation) ||
+		(old_state->zpos != new_state->zpos) ||
+		(old_exynos_state->colormap != new_exynos_state->colormap) ||
+		(old_exynos_state->standard != new_exynos_state->standard) ||
+		(old_exynos_state->transfer != new_exynos_state->transfer) ||
+		(old_exynos_state->range != new_exynos_state->range) ||
+		(old_exynos_state->max_luminance != new_exynos_state->max_luminance) ||
+		(old_exynos_state->min_luminance != new_exynos_state->min_luminance) ||
+		(old_exynos_state->eotf_lut != new_exynos_state->eotf_lut) ||
+		(old_exynos_state->oetf_lut != new_exynos_state->oetf_lut) ||
+		(old_exynos_state->gm != new_exynos_state->gm) ||
+		(old_exynos_state->tm != new_exynos_state->tm) ||
+		(old_exynos_state->block != new_exynos_state->block);
+}
+
+/*
+ * Translate FB_DAMAGE_CLIPS of a plane from framebuffer into crtc coordinates.
+ * Clipped src/dst aren't computed yet at this point of atomic check, so the
+ * requested (unclipped) coordinates are used.
+ */
+static void exynos_partial_add_fb_damage(struct drm_rect *damage,
+			const struct drm_plane_state *state)
+{
+	const struct drm_mode_rect *clips = drm_helper_get_plane_damage_clips(state);
+	const unsigned int num_clips = drm_plane_get_damage_clips_count(state);
+	const struct drm_rect dst = drm_plane_state_dest(state);
+	struct drm_rect src = drm_plane_state_src(state);
+	unsigned int i;
+
+	/* scaled or rotated planes are damaged as a whole */
+	if (exynos_plane_state_rotation(state) || exynos_plane_state_scaling(state)) {
+		exynos_partial_add_damage(damage, &dst);
+		return;
+	}
+
+	src.x1 >>= 16;
+	src.y1 >>= 16;
+	src.x2 = DIV_ROUND_UP(src.x2, 1 << 16);
+	src.y2 = DIV_ROUND_UP(src.y2, 1 << 16);
+
+	for (i = 0; i < num_clips; i++) {
+		struct drm_rect r = DRM_RECT_INIT(clips[i].x1, clips[i].y1,
+				clips[i].x2 - clips[i].x1, clips[i].y2 - clips[i].y1);
+
+		if (!drm_rect_intersect(&r, &src))
+			continue;
+
+		drm_rect_translate(&r, dst.x1 - src.x1, dst.y1 - src.y1);
+		exynos_partial_add_damage(damage, &r);
+	}
+}
+
+/*
+ * Derive update region from plane damage, for clients which don't request
+ * partial region on crtc. Besides FB_DAMAGE_CLIPS, planes which are enabled,
+ * disabled, moved or changed in any other way are damaged on both old and
+ * new positions.
+ */
+static int exynos_partial_get_plane_damage(const struct drm_crtc_state *crtc_state,
+			struct drm_rect *req)
+{
+	struct drm_atomic_state *state = crtc_state->state;
+	const struct drm_crtc *crtc = crtc_state->crtc;
+	const struct drm_plane_state *old_plane_state, *new_plane_state;
+	struct drm_plane *plane;
+	struct drm_rect damage = { 0 }, full;
+	int i;
+
+	for_each_oldnew_plane_in_state(state, plane, old_plane_state, new_plane_state, i) {
+		const bool old_enabled = old_plane_state->crtc == crtc && old_plane_state->fb;
+		const bool new_enabled = new_plane_state->crtc == crtc && new_plane_state->fb;
+		struct drm_rect old_dst, new_dst;
+
+		if (!old_enabled && !new_enabled)
+			continue;
+
+		old_dst = drm_plane_state_dest(old_plane_state);
+		new_dst = drm_plane_state_dest(new_plane_state);
+
+		if (old_enabled != new_enabled) {
+			if (old_enabled)
+				exynos_partial_add_damage(&damage, &old_dst);
+			else
+				exynos_partial_add_damage(&damage, &new_dst);
+			continue;
+		}
+
+		if (!drm_rect_equals(&old_dst, &new_dst) ||
+				exynos_plane_state_props_changed(old_plane_state,
+					new_plane_state)) {
+			exynos_partial_add_damage(&damage, &old_dst);
+			exynos_partial_add_damage(&damage, &new_dst);
+			continue;
+		}
+
+		if (drm_plane_get_damage_clips_count(new_plane_state)) {
+			const struct drm_rect old_src = drm_plane_state_src(old_plane_state);
+			const struct drm_rect new_src = drm_plane_state_src(new_plane_state);
+
+			if (drm_rect_equals(&old_src, &new_src))
+				exynos_partial_add_fb_damage(&damage, new_plane_state);
+			else
+				exynos_partial_add_damage(&damage, &new_dst);
+		} else if (old_plane_state->fb != new_plane_state->fb) {
+			/* no damage clips on new buffer means full plane update */
+			exynos_partial_add_damage(&damage, &new_dst);
+		}
+	}
+
+	exynos_partial_set_full(&crtc_state->mode, &full);
+	if (!drm_rect_intersect(&damage, &full)) {
+		pr_debug("changed full: no plane damage\n");
+		return -ENOENT;
+	}
+
+	pr_region("plane damage region", &damage);
+	*req = damage;
+
+	return 0;
+}
+
 void exynos_partial_prepare(struct exynos_partial *partial,
 			struct exynos_drm_crtc_state *old_exynos_crtc_state,
 			struct exynos_drm_crtc_state *new_exynos_crtc_state)
@@ -382,10 +689,10 @@ void exynos_partial_prepare(struct exynos_partial *partial,
 	const struct drm_rect *old_partial_r = &old_exynos_crtc_state->partial_region;
 	struct decon_device *decon = partial->decon;
 	struct dpu_log_partial plog;
-	struct drm_clip_rect *req_region;
-	struct drm_rect req;
+	struct drm_rect req = { 0 };
 	int ret = -ENOENT;
 	bool region_changed = false;
+	bool needs_adjust = false;
 
 	pr_debug("plane mask[0x%x]\n", crtc_state->plane_mask);
 
@@ -399,18 +706,38 @@ void exynos_partial_prepare(struct exynos_partial *partial,
 	if (!crtc_state->plane_mask)
 		return;
 
-	if (old_exynos_crtc_state->partial != new_exynos_crtc_state->partial) {
-		if (new_exynos_crtc_state->partial) {
-			req_region = new_exynos_crtc_state->partial->data;
-			req.x1 = req_region->x1;
-			req.y1 = req_region->y1;
-			req.x2 = req_region->x2;
-			req.y2 = req_region->y2;
+	/*
+	 * crtc wide properties affect the whole screen. mode and active changes
+	 * (including seamless mode switch, which is only detected later in crtc
+	 * check) are covered by the modeset check above.
+	 */
+	if (crtc_state->color_mgmt_changed) {
+		pr_debug("changed full: crtc property changed\n");
+		needs_adjust = true;
+	} else if (new_exynos_crtc_state->partial) {
+		if (old_exynos_crtc_state->partial != new_exynos_crtc_state->partial) {
+			ret = exynos_partial_merge_region(new_exynos_crtc_state->partial,
+					&req);
+			needs_adjust = true;
+		}
+	} else if (old_exynos_crtc_state->partial ||
+		   new_exynos_crtc_state->planes_updated) {
+		/*
+		 * no explicit request, fall back to damage of planes. planes_changed
+		 * is not set yet here as plane check runs after partial prepare.
+		 */
+		ret = exynos_partial_get_plane_damage(crtc_state, &req);
+		needs_adjust = true;
+	} else if (!exynos_partial_is_full(&crtc_state->mode, partial_r)) {
+		/* no damage in this commit, drop the region derived from the last one */
+		needs_adjust = true;
+	}
 
-			/* find adjusted update region on LCD */
+	if (needs_adjust) {
+		/* find adjusted update region on LCD */
+		if (!ret)
 			ret = partial->funcs->adjust_partial_region(partial,
 					&crtc_state->mode, &req, partial_r);
-		}
 
 		if (ret)
 			exynos_partial_set_full(&crtc_state->mode, partial_r);
@@ -426,15 +753,20 @@ void exynos_partial_prepare(struct exynos_partial *partial,
 		} else if (exynos_partial_is_full(&crtc_state->mode, partial_r)) {
 			return;
 		}
-	} else {
-		/* if region changed, DQE needs to be updated */
-		crtc_state->color_mgmt_changed = true;
 	}
 
 	/* check DPP hw limit if violated, update region is changed to full */
 	if (!partial->funcs->check(partial, new_exynos_crtc_state))
 		exynos_partial_set_full(&crtc_state->mode,
 				&new_exynos_crtc_state->partial_region);
+	else if (!exynos_partial_is_full(&crtc_state->mode, partial_r) &&
+			!partial->funcs->is_cost_effective(partial,
+				new_exynos_crtc_state, old_partial_r))
+		exynos_partial_set_full(&crtc_state->mode, partial_r);
+
+	/* if region changed, DQE needs to be updated */
+	if (!drm_rect_equals(partial_r, old_partial_r))
+		crtc_state->color_mgmt_changed = true;
 
 	pr_region("final update region", partial_r);
 
@@ -456,8 +788,12 @@ void exynos_partial_reconfig_coords(struct exynos_partial *partial,
 			struct drm_plane_state *plane_state,
 			const struct drm_rect *partial_r)
 {
-	plane_state->visible = drm_rect_clip_scaled(&plane_state->src,
-			&plane_state->dst, partial_r);
+	/*
+	 * Rotated and scaled planes are cropped on source by back-projection
+	 * of update region, as is_partial_supported() has validated.
+	 */
+	plane_state->visible = exynos_partial_project(plane_state, partial_r,
+			&plane_state->src, &plane_state->dst);
 	if (!plane_state->visible)
 		return;
 
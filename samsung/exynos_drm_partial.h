@@ -18,6 +18,9 @@
 struct decon_device;
 struct exynos_partial;
 
+/* maximum number of damage rectangles accepted in partial region blob */
+#define EXYNOS_PARTIAL_MAX_RECTS	8
+
 struct exynos_partial_funcs {
 	int (*init)(struct exynos_partial *partial,
 			const struct exynos_display_partial *partial_mode,
@@ -27,6 +30,9 @@ struct exynos_partial_funcs {
 			const struct drm_rect *req, struct drm_rect *r);
 	bool (*check)(struct exynos_partial *partial,
 			struct exynos_drm_crtc_state *exynos_crtc_state);
+	bool (*is_cost_effective)(struct exynos_partial *partial,
+			struct exynos_drm_crtc_state *exynos_crtc_state,
+			const struct drm_rect *old_partial_r);
 	int (*send_partial_command)(struct exynos_partial *partial,
 			const struct drm_rect *partial_r);
 	void (*set_partial_size)(struct exynos_partial *partial,
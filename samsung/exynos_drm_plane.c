@@ -12,6 +12,7 @@
 
 #include <drm/drm_atomic.h>
 #include <drm/drm_atomic_helper.h>
+#include <drm/drm_damage_helper.h>
 #include <drm/drm_plane_helper.h>
 #include <drm/exynos_drm.h>
 
@@ -243,31 +244,32 @@ static struct drm_plane_funcs exynos_plane_funcs = {
 };
 
 static int
-exynos_drm_plane_check_format(struct exynos_drm_plane_state *state)
+exynos_drm_plane_check_format(const struct dpp_device *dpp,
+			      struct exynos_drm_plane_state *state)
 {
 	struct drm_framebuffer *fb = state->base.fb;
+	const struct dpp_fmt_cap *fmt_cap;
+	int mod_class;
 
 	if (!fb)
 		return 0;
 
-	if (fb->modifier) {
-		uint64_t modifier = fb->modifier;
-
-		if (has_all_bits(DRM_FORMAT_MOD_SAMSUNG_COLORMAP, modifier))
-			return 0;
-
-		/* allow rest of the modifiers to support content protection */
-		modifier &= ~DRM_FORMAT_MOD_PROTECTION;
-
-		if (!modifier ||
-		    has_all_bits(DRM_FORMAT_MOD_ARM_AFBC(0), modifier) ||
-		    has_all_bits(DRM_FORMAT_MOD_SAMSUNG_SBWC(0), modifier))
-			return 0;
+	if (has_all_bits(DRM_FORMAT_MOD_SAMSUNG_COLORMAP, fb->modifier))
+		return 0;
 
+	mod_class = dpu_get_mod_class(fb->modifier);
+	if (mod_class < 0) {
 		DRM_ERROR("not supported modifier(0x%llx)\n", fb->modifier);
 		return -ENOTSUPP;
 	}
 
+	fmt_cap = dpp_get_fmt_cap(dpp, fb->format->format);
+	if (!fmt_cap || !(fmt_cap->caps[mod_class] & DPU_FMT_CAP_SUPPORTED)) {
+		DRM_ERROR("not supported format(0x%08x) with modifier(0x%llx)\n",
+				fb->format->format, fb->modifier);
+		return -ENOTSUPP;
+	}
+
 	return 0;
 }
 
@@ -352,16 +354,16 @@ static int exynos_plane_atomic_check(struct drm_plane *plane,
 
 	exynos_plane_update_hdr_params(exynos_state);
 
+	ret = exynos_drm_plane_check_format(dpp, exynos_state);
+	if (ret)
+		return ret;
+
 	if (dpp->check && state->visible) {
 		ret = dpp->check(dpp, exynos_state);
 		if (ret)
 			return ret;
 	}
 
-	ret = exynos_drm_plane_check_format(exynos_state);
-	if (ret)
-		return ret;
-
 	DRM_DEBUG("%s -\n", __func__);
 
 	return ret;
@@ -723,6 +725,7 @@ int exynos_plane_init(struct drm_device *dev,
 		exynos_drm_plane_create_transfer_property(exynos_plane);
 		exynos_drm_plane_create_range_property(exynos_plane);
 		exynos_drm_plane_create_colormap_property(exynos_plane);
+		drm_plane_enable_fb_damage_clips(plane);
 	} else {
 		drm_plane_create_zpos_immutable_property(plane, MAX_PLANE);
 		exynos_drm_plane_create_block_property(exynos_plane);
@@ -28,12 +28,97 @@
 #include "exynos_drm_decon.h"
 #include "exynos_drm_recovery.h"
 
-static void exynos_recovery_handler(struct work_struct *work)
+static const char * const recovery_tier_names[EXYNOS_RECOVERY_TIER_MAX] = {
+	[EXYNOS_RECOVERY_TIER_DPP] = "dpp",
+	[EXYNOS_RECOVERY_TIER_DECON] = "decon",
+	[EXYNOS_RECOVERY_TIER_MODESET] = "modeset",
+};
+
+const char *exynos_recovery_tier_name(enum exynos_recovery_tier tier)
+{
+	if (tier >= EXYNOS_RECOVERY_TIER_MAX)
+		return "unknown";
+
+	return recovery_tier_names[tier];
+}
+
+/*
+ * Repaint current state while resetting only the faulted blocks. All planes
+ * and color management are added to the commit, so the reset blocks are
+ * fully reprogrammed.
+ */
+static int exynos_recovery_repaint(struct decon_device *decon,
+				   enum exynos_recovery_tier tier,
+				   unsigned long dpp_mask)
+{
+	struct drm_device *dev = decon->drm_dev;
+	struct drm_modeset_acquire_ctx ctx;
+	struct drm_atomic_state *state;
+	struct drm_crtc_state *crtc_state;
+	struct exynos_drm_crtc_state *exynos_crtc_state;
+	struct drm_crtc *crtc = &decon->crtc->base;
+	int ret;
+
+	drm_modeset_acquire_init(&ctx, 0);
+
+	state = drm_atomic_state_alloc(dev);
+	if (!state) {
+		ret = -ENOMEM;
+		goto out_drop_locks;
+	}
+
+retry:
+	state->acquire_ctx = &ctx;
+
+	crtc_state = drm_atomic_get_crtc_state(state, crtc);
+	if (IS_ERR(crtc_state)) {
+		ret = PTR_ERR(crtc_state);
+		goto out;
+	}
+
+	/* nothing to recover if display was turned off in the meantime */
+	if (!crtc_state->active) {
+		ret = 0;
+		goto out;
+	}
+
+	exynos_crtc_state = to_exynos_crtc_state(crtc_state);
+	if (tier == EXYNOS_RECOVERY_TIER_DECON) {
+		exynos_crtc_state->recovery_reset = true;
+		crtc_state->color_mgmt_changed = true;
+	} else {
+		exynos_crtc_state->recovery_dpp_mask = dpp_mask;
+	}
+
+	ret = drm_atomic_add_affected_planes(state, crtc);
+	if (ret)
+		goto out;
+
+	ret = drm_atomic_add_affected_connectors(state, crtc);
+	if (ret)
+		goto out;
+
+	ret = drm_atomic_commit(state);
+
+out:
+	if (ret == -EDEADLK) {
+		drm_atomic_state_clear(state);
+		ret = drm_modeset_backoff(&ctx);
+		if (!ret)
+			goto retry;
+	}
+
+	drm_atomic_state_put(state);
+
+out_drop_locks:
+	drm_modeset_drop_locks(&ctx);
+	drm_modeset_acquire_fini(&ctx);
+
+	return ret;
+}
+
+static int exynos_recovery_modeset(struct decon_device *decon)
 {
-	struct exynos_recovery *recovery = container_of(work,
-					struct exynos_recovery, work);
-	struct decon_device *decon = container_of(recovery, struct decon_device,
-					recovery);
 	struct drm_device *dev = decon->drm_dev;
 	struct drm_modeset_acquire_ctx ctx;
 	struct drm_atomic_state *state, *rcv_state;
@@ -45,8 +130,6 @@ static void exynos_recovery_handler(struct work_struct *work)
 	struct drm_plane_state *plane_state;
 	int ret, i;
 
-	pr_info("starting recovery...\n");
-
 	drm_modeset_acquire_init(&ctx, 0);
 
 	rcv_state = drm_atomic_helper_duplicate_state(dev, &ctx);
@@ -57,6 +140,7 @@ static void exynos_recovery_handler(struct work_struct *work)
 
 	state = drm_atomic_state_alloc(dev);
 	if (!state) {
+		drm_atomic_state_put(rcv_state);
 		ret = -ENOMEM;
 		goto out_drop_locks;
 	}
@@ -104,11 +188,6 @@ retry:
 
 	drm_mode_config_reset(dev);
 	ret = drm_atomic_helper_commit_duplicated_state(rcv_state, &ctx);
-	if (ret)
-		goto out;
-
-	recovery->count++;
-	pr_info("recovery is successfully finished(%d)\n", recovery->count);
 
 out:
 	if (ret == -EDEADLK) {
@@ -123,9 +202,98 @@ out:
 	drm_atomic_state_put(rcv_state);
 
 out_drop_locks:
-	atomic_set(&recovery->recovering, 0);
 	drm_modeset_drop_locks(&ctx);
 	drm_modeset_acquire_fini(&ctx);
+
+	return ret;
+}
+
+/*
+ * Recovery attempt is considered successful if a frame could be completed
+ * after it, and no new fault has been reported in the meantime.
+ */
+static bool exynos_recovery_verify(struct decon_device *decon, int fault_cnt)
+{
+	const u32 fps = decon->bts.fps ? : 60;
+	const unsigned long timeout = msecs_to_jiffies(
+			DIV_ROUND_UP(MSEC_PER_SEC, fps) + 100);
+
+	if (!wait_event_timeout(decon->framedone_wait,
+				atomic_read(&decon->frames_pending) == 0,
+				timeout))
+		return false;
+
+	return atomic_read(&decon->recovery.fault_cnt) == fault_cnt;
+}
+
+static void exynos_recovery_account(struct exynos_recovery *recovery,
+				    enum exynos_recovery_tier tier, bool success)
+{
+	struct exynos_recovery_tier_stats *stats = &recovery->stats[tier];
+	const u64 delta_us = ktime_us_delta(ktime_get(), recovery->detect_time);
+	unsigned long flags;
+
+	spin_lock_irqsave(&recovery->stats_lock, flags);
+	stats->attempts++;
+	if (success) {
+		stats->successes++;
+		stats->total_us += delta_us;
+		stats->max_us = max(stats->max_us, delta_us);
+		recovery->last_us = delta_us;
+	}
+	spin_unlock_irqrestore(&recovery->stats_lock, flags);
+}
+
+static void exynos_recovery_handler(struct work_struct *work)
+{
+	struct exynos_recovery *recovery = container_of(work,
+					struct exynos_recovery, work);
+	struct decon_device *decon = container_of(recovery, struct decon_device,
+					recovery);
+	const unsigned long req_tiers = xchg(&recovery->req_tiers, 0);
+	const unsigned long dpp_mask = xchg(&recovery->dpp_fault_mask, 0);
+	enum exynos_recovery_tier tier;
+	bool success = false;
+	int ret, fault_cnt;
+
+	tier = req_tiers ? __ffs(req_tiers) : EXYNOS_RECOVERY_TIER_MODESET;
+	if (tier == EXYNOS_RECOVERY_TIER_DPP && !dpp_mask)
+		tier = EXYNOS_RECOVERY_TIER_DECON;
+
+	pr_info("starting recovery from %s tier...\n",
+		exynos_recovery_tier_name(tier));
+
+	hibernation_block_exit(decon->hibernation);
+
+	for (; tier < EXYNOS_RECOVERY_TIER_MAX; tier++) {
+		fault_cnt = atomic_read(&recovery->fault_cnt);
+
+		if (tier == EXYNOS_RECOVERY_TIER_MODESET)
+			ret = exynos_recovery_modeset(decon);
+		else
+			ret = exynos_recovery_repaint(decon, tier, dpp_mask);
+
+		success = !ret && exynos_recovery_verify(decon, fault_cnt);
+		exynos_recovery_account(recovery, tier, success);
+		if (success)
+			break;
+
+		pr_warn("%s tier recovery failed(%d)\n",
+			exynos_recovery_tier_name(tier), ret);
+	}
+
+	hibernation_unblock_enter(decon->hibernation);
+
+	if (success) {
+		recovery->count++;
+		pr_info("recovery is successfully finished by %s tier(%d)\n",
+			exynos_recovery_tier_name(tier), recovery->count);
+	} else {
+		recovery->failures++;
+		pr_err("recovery failed(%u)\n", recovery->failures);
+	}
+
+	atomic_set(&recovery->recovering, 0);
 }
 
 void exynos_recovery_register(struct decon_device *decon)
@@ -134,7 +302,14 @@ void exynos_recovery_register(struct decon_device *decon)
 
 	INIT_WORK(&recovery->work, exynos_recovery_handler);
 	recovery->count = 0;
+	recovery->failures = 0;
+	recovery->last_us = 0;
+	recovery->req_tiers = 0;
+	recovery->dpp_fault_mask = 0;
 	atomic_set(&recovery->recovering, 0);
+	atomic_set(&recovery->fault_cnt, 0);
+	spin_lock_init(&recovery->stats_lock);
+	memset(recovery->stats, 0, sizeof(recovery->stats));
 
 	pr_info("ESD recovery is supported\n");
 }
@@ -16,14 +16,52 @@
 #define __EXYNOS_DRM_RECOVERY__
 
 #include <linux/kthread.h>
+#include <linux/ktime.h>
+#include <linux/spinlock.h>
+
+/*
+ * Recovery is attempted starting from the cheapest tier able to handle the
+ * reported fault, escalating to the next tier if the fault persists.
+ */
+enum exynos_recovery_tier {
+	/* reinit only the faulted DPP(s) on next repaint */
+	EXYNOS_RECOVERY_TIER_DPP,
+	/* stop/reset DECON and restore its state, panel and link are kept on */
+	EXYNOS_RECOVERY_TIER_DECON,
+	/* full modeset of the whole pipeline including panel */
+	EXYNOS_RECOVERY_TIER_MODESET,
+	EXYNOS_RECOVERY_TIER_MAX,
+};
+
+struct exynos_recovery_tier_stats {
+	u32 attempts;
+	u32 successes;
+	u64 total_us;	/* accumulated fault detection to recovered time */
+	u64 max_us;
+};
 
 struct decon_device;
 struct exynos_recovery {
 	struct work_struct work;
 	int count;
 	atomic_t recovering;
+
+	/* bitmask of tiers requested by fault reporters */
+	unsigned long req_tiers;
+	/* bitmask of DPP ids reported as faulted */
+	unsigned long dpp_fault_mask;
+	/* incremented on every fault, used to validate a recovery attempt */
+	atomic_t fault_cnt;
+	ktime_t detect_time;
+
+	spinlock_t stats_lock;
+	struct exynos_recovery_tier_stats stats[EXYNOS_RECOVERY_TIER_MAX];
+	u32 failures;
+	/* detection to first good frame of the last successful recovery */
+	u64 last_us;
 };
 
 void exynos_recovery_register(struct decon_device *decon);
+const char *exynos_recovery_tier_name(enum exynos_recovery_tier tier);
 
 #endif /* __EXYNOS_DRM_RECOVERY__ */
@@ -20,6 +20,7 @@
 #include <linux/dma-buf.h>
 #include <linux/of_address.h>
 #include <linux/of_irq.h>
+#include <linux/pm_runtime.h>
 
 #include <drm/exynos_drm.h>
 #include <drm/drm_atomic.h>
@@ -86,26 +87,22 @@ static int writeback_get_modes(struct drm_connector *connector)
 				    dev->mode_config.max_height);
 }
 
-static void wb_convert_connector_state_to_config(struct dpp_params_info *config,
-				const struct exynos_drm_writeback_state *state)
+static void wb_convert_fb_to_config(struct dpp_params_info *config,
+				const struct drm_framebuffer *fb, u32 width,
+				u32 height, u32 standard, u32 range)
 {
-	struct drm_framebuffer *fb = state->base.writeback_job->fb;
-	const struct drm_crtc_state *crtc_state = state->base.crtc->state;
-
-	pr_debug("%s +\n", __func__);
-
 	config->src.x = 0;
 	config->src.y = 0;
-	config->src.w = crtc_state->mode.hdisplay;
-	config->src.h = crtc_state->mode.vdisplay;
+	config->src.w = width;
+	config->src.h = height;
 	config->src.f_w = fb->width;
 	config->src.f_h = fb->height;
 
 	config->comp_type = COMP_TYPE_NONE;
 
 	config->format = fb->format->format;
-	config->standard = state->standard;
-	config->range = state->range;
+	config->standard = standard;
+	config->range = range;
 	config->y_hd_y2_stride = 0;
 	config->y_pl_c2_stride = 0;
 	config->c_hd_stride = 0;
@@ -120,29 +117,49 @@ static void wb_convert_connector_state_to_config(struct dpp_params_info *config,
 	config->is_block = false;
 	/* TODO: very big count.. recovery will be not working... */
 	config->rcv_num = 0x7FFFFFFF;
+}
+
+static void wb_convert_connector_state_to_config(struct dpp_params_info *config,
+				const struct exynos_drm_writeback_state *state)
+{
+	struct drm_framebuffer *fb = state->base.writeback_job->fb;
+	const struct drm_crtc_state *crtc_state = state->base.crtc->state;
+
+	pr_debug("%s +\n", __func__);
+
+	wb_convert_fb_to_config(config, fb, crtc_state->mode.hdisplay,
+			crtc_state->mode.vdisplay, state->standard, state->range);
 
 	pr_debug("%s -\n", __func__);
 }
 
+static bool wb_is_format_supported(const struct drm_framebuffer *fb)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(writeback_formats); i++)
+		if (fb->format->format == writeback_formats[i])
+			return true;
+
+	return false;
+}
+
 static int writeback_atomic_check(struct drm_encoder *encoder,
 				struct drm_crtc_state *crtc_state,
 				struct drm_connector_state *conn_state)
 {
-	const struct drm_framebuffer *fb;
-	int i;
+	const struct writeback_device *wb = enc_to_wb_dev(encoder);
 
 	conn_state->self_refresh_aware = true;
 
 	if (!wb_check_job(conn_state))
 		return 0;
 
-	fb = conn_state->writeback_job->fb;
-
-	for (i = 0; i < ARRAY_SIZE(writeback_formats); i++)
-		if (fb->format->format == writeback_formats[i])
-			break;
+	/* jobs can't be mixed with a streaming capture on same writeback */
+	if (READ_ONCE(wb->stream.active))
+		return -EBUSY;
 
-	if (i == ARRAY_SIZE(writeback_formats))
+	if (!wb_is_format_supported(conn_state->writeback_job->fb))
 		return -EINVAL;
 
 	return 0;
@@ -293,6 +310,432 @@ static const struct drm_connector_funcs wb_connector_funcs = {
 	.atomic_get_property = exynos_drm_writeback_get_property,
 };
 
+struct exynos_drm_pending_wb_stream_event {
+	struct drm_pending_event base;
+	struct exynos_drm_wb_stream_event event;
+};
+
+#define WB_STREAM_STOP_TIMEOUT	msecs_to_jiffies(100)
+
+/* returns true if the buffer of the event has been handed to userspace */
+static bool writeback_stream_send_event_locked(struct writeback_device *wb)
+{
+	struct drm_device *dev = wb->writeback.base.dev;
+	struct exynos_drm_pending_wb_stream_event *e;
+	const u32 sequence = wb->stream.sequence++;
+
+	e = kzalloc(sizeof(*e), GFP_ATOMIC);
+	if (!e)
+		goto drop;
+
+	e->event.base.type = EXYNOS_DRM_WB_STREAM_EVENT;
+	e->event.base.length = sizeof(e->event);
+	e->event.timestamp_ns = ktime_get_ns();
+	e->event.connector_id = wb->writeback.base.base.id;
+	e->event.sequence = sequence;
+	e->event.index = wb->stream.cur;
+
+	/* fails if userspace isn't keeping up with reading events */
+	if (drm_event_reserve_init(dev, wb->stream.file, &e->base,
+				   &e->event.base)) {
+		kfree(e);
+		goto drop;
+	}
+
+	drm_send_event(dev, &e->base);
+
+	return true;
+drop:
+	wb->stream.dropped++;
+	pr_debug("wb(%d) stream event(%u) dropped\n", wb->id, sequence);
+
+	return false;
+}
+
+/*
+ * Program next ring buffer which isn't held by userspace into ODMA and enable
+ * CWB path of DECON. If all buffers are held, the frame is dropped and CWB
+ * path is disabled.
+ */
+static bool writeback_stream_arm_locked(struct writeback_device *wb)
+{
+	struct dpp_params_info *config = &wb->win_config;
+	u32 i, idx = wb->stream.cur;
+
+	for (i = 0; i < wb->stream.num_bufs; i++) {
+		idx = (wb->stream.cur + i) % wb->stream.num_bufs;
+		if (!(wb->stream.user_mask & BIT(idx)))
+			break;
+	}
+
+	if (i == wb->stream.num_bufs) {
+		decon_reg_set_cwb_enable(wb->decon_id, false);
+		wb->stream.dropped++;
+		pr_debug("wb(%d) stream frame dropped, no released buffer\n",
+				wb->id);
+		return false;
+	}
+
+	wb->stream.cur = idx;
+	wb_convert_fb_to_config(config, wb->stream.fbs[idx],
+			wb->stream.width, wb->stream.height,
+			wb->stream.standard, wb->stream.range);
+	dpp_reg_configure_params(wb->id, config, wb->attr);
+	decon_reg_set_cwb_enable(wb->decon_id, true);
+	wb->stream.busy = true;
+
+	return true;
+}
+
+bool writeback_stream_arm(struct writeback_device *wb,
+			  const struct drm_crtc_state *crtc_state)
+{
+	unsigned long flags;
+	bool armed = false;
+
+	if (!wb)
+		return false;
+
+	spin_lock_irqsave(&wb->odma_slock, flags);
+	if (wb->state == WB_STATE_ON && wb->stream.active &&
+	    crtc_state->mode.hdisplay == wb->stream.width &&
+	    crtc_state->mode.vdisplay == wb->stream.height)
+		armed = writeback_stream_arm_locked(wb);
+	spin_unlock_irqrestore(&wb->odma_slock, flags);
+
+	return armed;
+}
+
+struct drm_framebuffer *writeback_stream_get_fb(struct writeback_device *wb)
+{
+	struct drm_framebuffer *fb = NULL;
+	unsigned long flags;
+
+	if (!wb)
+		return NULL;
+
+	spin_lock_irqsave(&wb->odma_slock, flags);
+	if (wb->stream.active) {
+		fb = wb->stream.fbs[0];
+		drm_framebuffer_get(fb);
+	}
+	spin_unlock_irqrestore(&wb->odma_slock, flags);
+
+	return fb;
+}
+
+static void writeback_stream_frame_done_locked(struct writeback_device *wb,
+					       bool done)
+{
+	wb->stream.busy = false;
+
+	if (!wb->stream.active) {
+		decon_reg_set_cwb_enable(wb->decon_id, false);
+		wake_up_all(&wb->stream.wait);
+		return;
+	}
+
+	/* on instant off the buffer content isn't valid, capture it again */
+	if (done && ++wb->stream.frame_cnt >= wb->stream.decimation) {
+		wb->stream.frame_cnt = 0;
+		if (writeback_stream_send_event_locked(wb))
+			wb->stream.user_mask |= BIT(wb->stream.cur);
+		wb->stream.cur = (wb->stream.cur + 1) % wb->stream.num_bufs;
+	}
+
+	/*
+	 * Video mode keeps capturing from here, command mode is armed again
+	 * on next frame update anyway. If userspace holds all buffers, video
+	 * mode is armed again once a buffer is released.
+	 */
+	writeback_stream_arm_locked(wb);
+}
+
+static void writeback_stream_retire_work(struct work_struct *work)
+{
+	struct writeback_device *wb = container_of(to_delayed_work(work),
+			struct writeback_device, stream.retire_work);
+	u32 i;
+
+	for (i = 0; i < wb->stream.num_retired; i++) {
+		drm_framebuffer_put(wb->stream.retired_fbs[i]);
+		wb->stream.retired_fbs[i] = NULL;
+	}
+	wb->stream.num_retired = 0;
+}
+
+/*
+ * Stop streaming capture. Buffers can't be released while hw may still be
+ * writing them, so it waits for the last frame unless @wait is false. In that
+ * case buffers are put from retire work after the frame would have ended, this
+ * is used from commit tail which shouldn't be blocked.
+ */
+static void writeback_stream_stop(struct writeback_device *wb, bool wait)
+{
+	struct drm_framebuffer *fbs[WB_STREAM_MAX_BUFS];
+	struct decon_device *decon = get_decon_drvdata(wb->decon_id);
+	unsigned long flags;
+	bool powered, hw_busy;
+	u32 i, num_bufs;
+
+	powered = decon && pm_runtime_get_if_in_use(decon->dev) > 0;
+
+	spin_lock_irqsave(&wb->odma_slock, flags);
+	if (!wb->stream.active) {
+		spin_unlock_irqrestore(&wb->odma_slock, flags);
+		if (powered)
+			pm_runtime_put(decon->dev);
+		return;
+	}
+
+	wb->stream.active = false;
+	wb->stream.file = NULL;
+	num_bufs = wb->stream.num_bufs;
+	memcpy(fbs, wb->stream.fbs, sizeof(fbs));
+	memset(wb->stream.fbs, 0, sizeof(wb->stream.fbs));
+	wb->stream.num_bufs = 0;
+	wb->stream.user_mask = 0;
+
+	if (powered) {
+		decon_reg_set_cwb_enable(decon->id, false);
+		decon_reg_all_win_shadow_update_req(decon->id);
+	}
+	spin_unlock_irqrestore(&wb->odma_slock, flags);
+
+	hw_busy = powered && (decon->config.mode.op_mode == DECON_VIDEO_MODE ||
+			atomic_read(&decon->frames_pending));
+
+	if (hw_busy && wait &&
+	    !wait_event_timeout(wb->stream.wait, !READ_ONCE(wb->stream.busy),
+				WB_STREAM_STOP_TIMEOUT))
+		pr_warn("wb(%d) stream stop timed out\n", wb->id);
+
+	if (powered)
+		pm_runtime_put(decon->dev);
+
+	spin_lock_irqsave(&wb->odma_slock, flags);
+	wb->stream.busy = false;
+	spin_unlock_irqrestore(&wb->odma_slock, flags);
+
+	if (hw_busy && !wait) {
+		/* only if a stream was restarted and stopped again in between */
+		flush_delayed_work(&wb->stream.retire_work);
+
+		memcpy(wb->stream.retired_fbs, fbs, sizeof(fbs));
+		wb->stream.num_retired = num_bufs;
+		schedule_delayed_work(&wb->stream.retire_work,
+				      WB_STREAM_STOP_TIMEOUT);
+	} else {
+		for (i = 0; i < num_bufs; i++)
+			drm_framebuffer_put(fbs[i]);
+	}
+
+	pr_info("wb(%d) stream stopped, captured(%u) dropped(%u)\n", wb->id,
+			wb->stream.sequence, wb->stream.dropped);
+}
+
+static struct writeback_device *
+wb_stream_lookup(struct drm_device *dev, struct drm_file *file, u32 conn_id,
+		 struct drm_connector **connector)
+{
+	*connector = drm_connector_lookup(dev, file, conn_id);
+	if (!*connector)
+		return ERR_PTR(-ENOENT);
+
+	if ((*connector)->connector_type != DRM_MODE_CONNECTOR_WRITEBACK) {
+		drm_connector_put(*connector);
+		return ERR_PTR(-EINVAL);
+	}
+
+	return conn_to_wb_dev(*connector);
+}
+
+int exynos_wb_stream_start_ioctl(struct drm_device *dev, void *data,
+				 struct drm_file *file)
+{
+	struct exynos_drm_wb_stream_start *req = data;
+	struct drm_framebuffer *fbs[WB_STREAM_MAX_BUFS] = { NULL };
+	struct drm_connector *connector;
+	const struct exynos_drm_writeback_state *wb_state;
+	const struct drm_crtc_state *crtc_state;
+	struct writeback_device *wb;
+	struct decon_device *decon;
+	unsigned long flags;
+	u32 i;
+	int ret = 0;
+
+	if (!req->num_bufs || req->num_bufs > WB_STREAM_MAX_BUFS)
+		return -EINVAL;
+
+	wb = wb_stream_lookup(dev, file, req->connector_id, &connector);
+	if (IS_ERR(wb))
+		return PTR_ERR(wb);
+
+	drm_modeset_lock_all(dev);
+
+	wb_state = to_exynos_wb_state(connector->state);
+	if (!wb_state->base.crtc || wb->state != WB_STATE_ON) {
+		pr_err("wb(%d) is not attached to crtc\n", wb->id);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	crtc_state = wb_state->base.crtc->state;
+	decon = to_exynos_crtc(wb_state->base.crtc)->ctx;
+	if (!crtc_state->active || decon->config.out_type == DECON_OUT_WB) {
+		pr_err("wb(%d) stream is only supported for active cwb\n",
+				wb->id);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	for (i = 0; i < req->num_bufs; i++) {
+		fbs[i] = drm_framebuffer_lookup(dev, file, req->fb_ids[i]);
+		if (!fbs[i]) {
+			ret = -ENOENT;
+			goto out;
+		}
+
+		if (!wb_is_format_supported(fbs[i]) ||
+		    fbs[i]->width < crtc_state->mode.hdisplay ||
+		    fbs[i]->height < crtc_state->mode.vdisplay) {
+			pr_err("wb(%d) invalid stream buffer(%u)\n", wb->id,
+					req->fb_ids[i]);
+			ret = -EINVAL;
+			goto out;
+		}
+	}
+
+	spin_lock_irqsave(&wb->odma_slock, flags);
+	if (wb->stream.active || wb->stream.busy) {
+		spin_unlock_irqrestore(&wb->odma_slock, flags);
+		ret = -EBUSY;
+		goto out;
+	}
+
+	memcpy(wb->stream.fbs, fbs, sizeof(fbs));
+	wb->stream.num_bufs = req->num_bufs;
+	wb->stream.decimation = req->decimation ? : 1;
+	wb->stream.width = crtc_state->mode.hdisplay;
+	wb->stream.height = crtc_state->mode.vdisplay;
+	wb->stream.standard = wb_state->standard;
+	wb->stream.range = wb_state->range;
+	wb->stream.cur = 0;
+	wb->stream.user_mask = 0;
+	wb->stream.frame_cnt = 0;
+	wb->stream.sequence = 0;
+	wb->stream.dropped = 0;
+	wb->stream.file = file;
+	wb->stream.active = true;
+
+	/* video mode doesn't get frame updates, start capturing right away */
+	if (decon->state == DECON_STATE_ON &&
+	    decon->config.mode.op_mode == DECON_VIDEO_MODE) {
+		writeback_stream_arm_locked(wb);
+		decon_reg_all_win_shadow_update_req(decon->id);
+	}
+	spin_unlock_irqrestore(&wb->odma_slock, flags);
+
+	/* references are owned by the stream now */
+	memset(fbs, 0, sizeof(fbs));
+
+	pr_info("wb(%d) stream started, bufs(%u) decimation(%u)\n", wb->id,
+			wb->stream.num_bufs, wb->stream.decimation);
+out:
+	drm_modeset_unlock_all(dev);
+
+	for (i = 0; i < req->num_bufs; i++)
+		if (fbs[i])
+			drm_framebuffer_put(fbs[i]);
+
+	drm_connector_put(connector);
+
+	return ret;
+}
+
+int exynos_wb_stream_stop_ioctl(struct drm_device *dev, void *data,
+				struct drm_file *file)
+{
+	u32 *conn_id = data;
+	struct drm_connector *connector;
+	struct writeback_device *wb;
+	int ret = 0;
+
+	wb = wb_stream_lookup(dev, file, *conn_id, &connector);
+	if (IS_ERR(wb))
+		return PTR_ERR(wb);
+
+	if (READ_ONCE(wb->stream.file) != file)
+		ret = -EPERM;
+	else
+		writeback_stream_stop(wb, true);
+
+	drm_connector_put(connector);
+
+	return ret;
+}
+
+int exynos_wb_stream_release_ioctl(struct drm_device *dev, void *data,
+				   struct drm_file *file)
+{
+	struct exynos_drm_wb_stream_release *req = data;
+	struct drm_connector *connector;
+	struct writeback_device *wb;
+	struct decon_device *decon;
+	unsigned long flags;
+	bool powered;
+	int ret = 0;
+
+	wb = wb_stream_lookup(dev, file, req->connector_id, &connector);
+	if (IS_ERR(wb))
+		return PTR_ERR(wb);
+
+	decon = get_decon_drvdata(READ_ONCE(wb->decon_id));
+	powered = decon && pm_runtime_get_if_in_use(decon->dev) > 0;
+
+	spin_lock_irqsave(&wb->odma_slock, flags);
+	if (wb->stream.file != file) {
+		ret = -EPERM;
+	} else if (req->index >= wb->stream.num_bufs ||
+		   !(wb->stream.user_mask & BIT(req->index))) {
+		ret = -EINVAL;
+	} else {
+		wb->stream.user_mask &= ~BIT(req->index);
+
+		/* video mode capture stalls while all buffers are held */
+		if (powered && !wb->stream.busy && wb->state == WB_STATE_ON &&
+		    decon->config.mode.op_mode == DECON_VIDEO_MODE &&
+		    writeback_stream_arm_locked(wb))
+			decon_reg_all_win_shadow_update_req(decon->id);
+	}
+	spin_unlock_irqrestore(&wb->odma_slock, flags);
+
+	if (powered)
+		pm_runtime_put(decon->dev);
+
+	drm_connector_put(connector);
+
+	return ret;
+}
+
+void exynos_wb_stream_release(struct drm_device *dev, struct drm_file *file)
+{
+	struct drm_connector *connector;
+	struct drm_connector_list_iter conn_iter;
+	struct writeback_device *wb;
+
+	drm_connector_list_iter_begin(dev, &conn_iter);
+	drm_for_each_connector_iter(connector, &conn_iter) {
+		if (connector->connector_type != DRM_MODE_CONNECTOR_WRITEBACK)
+			continue;
+
+		wb = conn_to_wb_dev(connector);
+		if (READ_ONCE(wb->stream.file) == file)
+			writeback_stream_stop(wb, true);
+	}
+	drm_connector_list_iter_end(&conn_iter);
+}
+
 static void _writeback_enable(struct writeback_device *wb)
 {
 	dpp_reg_init(wb->id, wb->attr);
@@ -353,6 +796,7 @@ static void writeback_disable(struct drm_encoder *encoder)
 		return;
 	}
 
+	writeback_stream_stop(wb, false);
 	_writeback_disable(wb);
 	wb->state = WB_STATE_OFF;
 	DPU_EVENT_LOG(DPU_EVT_WB_DISABLE, wb->decon_id, wb);
@@ -498,7 +942,10 @@ static int writeback_bind(struct device *dev, struct device *master, void *data)
 static void
 writeback_unbind(struct device *dev, struct device *master, void *data)
 {
+	struct writeback_device *wb = dev_get_drvdata(dev);
+
 	pr_debug("%s +\n", __func__);
+	flush_delayed_work(&wb->stream.retire_work);
 	pr_debug("%s -\n", __func__);
 }
 
@@ -588,10 +1035,15 @@ static irqreturn_t odma_irq_handler(int irq, void *priv)
 		else
 			pr_warn("wb(%d) instant off irq occurs\n", wb->id);
 
-		if (wb_check_type(wb, &is_cwb) || is_cwb)
-			decon_reg_set_cwb_enable(wb->decon_id, false);
+		if (wb->stream.busy) {
+			writeback_stream_frame_done_locked(wb,
+					irqs & ODMA_STATUS_FRAMEDONE_IRQ);
+		} else {
+			if (wb_check_type(wb, &is_cwb) || is_cwb)
+				decon_reg_set_cwb_enable(wb->decon_id, false);
 
-		drm_writeback_signal_completion(&wb->writeback, 0);
+			drm_writeback_signal_completion(&wb->writeback, 0);
+		}
 		DPU_EVENT_LOG(DPU_EVT_WB_FRAMEDONE, wb->decon_id, wb);
 	}
 
@@ -678,6 +1130,9 @@ static int writeback_probe(struct platform_device *pdev)
 	writeback->output_type = EXYNOS_DISPLAY_TYPE_VIDI;
 
 	spin_lock_init(&writeback->odma_slock);
+	init_waitqueue_head(&writeback->stream.wait);
+	INIT_DELAYED_WORK(&writeback->stream.retire_work,
+			  writeback_stream_retire_work);
 
 	writeback->state = WB_STATE_OFF;
 
@@ -14,7 +14,10 @@
 #ifndef _EXYNOS_DRM_WRTIEBACK_H_
 #define _EXYNOS_DRM_WRTIEBACK_H_
 
+#include <linux/wait.h>
+#include <linux/workqueue.h>
 #include <drm/drm_writeback.h>
+#include <uapi/drm/exynos_drm_ext.h>
 
 #include <decon_cal.h>
 #include <dpp_cal.h>
@@ -25,6 +28,8 @@
 
 extern const struct dpp_restriction dpp_drv_data;
 
+#define WB_STREAM_MAX_BUFS	EXYNOS_DRM_WB_STREAM_MAX_BUFS
+
 enum writeback_state {
 	WB_STATE_OFF = 0,
 	WB_STATE_ON,
@@ -56,6 +61,36 @@ struct writeback_device {
 		struct drm_property *range;
 		struct drm_property *restriction;
 	} props;
+
+	/* protected by odma_slock */
+	struct {
+		bool active;
+		/* a ring buffer is programmed in ODMA, hw may be writing it */
+		bool busy;
+		struct drm_file *file;
+		struct drm_framebuffer *fbs[WB_STREAM_MAX_BUFS];
+		u32 num_bufs;
+		u32 decimation;
+		u32 width;
+		u32 height;
+		u32 standard;
+		u32 range;
+		u32 cur;
+		/* buffers handed to userspace by an event and not released yet */
+		u32 user_mask;
+		u32 frame_cnt;
+		u32 sequence;
+		u32 dropped;
+		wait_queue_head_t wait;
+
+		/*
+		 * buffers of a stream stopped from commit tail, they're put by
+		 * retire_work once hw can't be writing them anymore
+		 */
+		struct drm_framebuffer *retired_fbs[WB_STREAM_MAX_BUFS];
+		u32 num_retired;
+		struct delayed_work retire_work;
+	} stream;
 };
 
 struct exynos_drm_writeback_state {
@@ -100,4 +135,45 @@ void wb_dump(struct drm_printer *p, struct writeback_device *wb);
 
 void writeback_exit_hibernation(struct writeback_device *wb);
 void writeback_enter_hibernation(struct writeback_device *wb);
+
+#if IS_ENABLED(CONFIG_DRM_SAMSUNG_WB)
+int exynos_wb_stream_start_ioctl(struct drm_device *dev, void *data,
+				 struct drm_file *file);
+int exynos_wb_stream_stop_ioctl(struct drm_device *dev, void *data,
+				struct drm_file *file);
+int exynos_wb_stream_release_ioctl(struct drm_device *dev, void *data,
+				   struct drm_file *file);
+void exynos_wb_stream_release(struct drm_device *dev, struct drm_file *file);
+bool writeback_stream_arm(struct writeback_device *wb,
+			  const struct drm_crtc_state *crtc_state);
+struct drm_framebuffer *writeback_stream_get_fb(struct writeback_device *wb);
+#else
+static inline int exynos_wb_stream_start_ioctl(struct drm_device *dev,
+				void *data, struct drm_file *file)
+{
+	return -ENODEV;
+}
+static inline int exynos_wb_stream_stop_ioctl(struct drm_device *dev,
+				void *data, struct drm_file *file)
+{
+	return -ENODEV;
+}
+static inline int exynos_wb_stream_release_ioctl(struct drm_device *dev,
+				void *data, struct drm_file *file)
+{
+	return -ENODEV;
+}
+static inline void exynos_wb_stream_release(struct drm_device *dev,
+					    struct drm_file *file) { }
+static inline bool writeback_stream_arm(struct writeback_device *wb,
+				const struct drm_crtc_state *crtc_state)
+{
+	return false;
+}
+static inline struct drm_framebuffer *
+writeback_stream_get_fb(struct writeback_device *wb)
+{
+	return NULL;
+}
+#endif
 #endif
@@ -1302,6 +1302,20 @@ static u16 nt37290_convert_to_dvt1_nonlinear_br(struct exynos_panel *ctx, u16 br
 	return level;
 }
 
+static u16 nt37290_convert_brightness(struct exynos_panel *ctx, u16 br)
+{
+	if (ctx->panel_rev >= PANEL_REV_DVT1)
+		return nt37290_convert_to_dvt1_nonlinear_br(ctx, br);
+
+	if (ctx->panel_rev == PANEL_REV_EVT1_1) {
+		if (br <= evt1_1_br_settings.normal_band_data[0].level)
+			return nt37290_convert_to_evt1_1_nonlinear_br(ctx, br);
+		return br;
+	}
+
+	return nt37290_convert_to_evt1_br(ctx, br);
+}
+
 static int nt37290_set_brightness(struct exynos_panel *ctx, u16 br)
 {
 	u16 brightness;
@@ -1315,17 +1329,8 @@ static int nt37290_set_brightness(struct exynos_panel *ctx, u16 br)
 		return exynos_dcs_set_brightness(ctx, 0);
 	}
 
-	if (spanel->hw_dbv) {
-		if (ctx->panel_rev >= PANEL_REV_DVT1) {
-			spanel->hw_dbv = nt37290_convert_to_dvt1_nonlinear_br(ctx, br);
-		} else if (ctx->panel_rev == PANEL_REV_EVT1_1) {
-			if (br <= evt1_1_br_settings.normal_band_data[0].level)
-				spanel->hw_dbv =
-					nt37290_convert_to_evt1_1_nonlinear_br(ctx, br);
-		} else {
-			spanel->hw_dbv = nt37290_convert_to_evt1_br(ctx, br);
-		}
-	}
+	if (spanel->hw_dbv)
+		spanel->hw_dbv = exynos_panel_get_dbv(ctx, br);
 
 	if (lp_mode) {
 		const struct exynos_panel_funcs *funcs;
@@ -1803,6 +1808,7 @@ static const struct drm_panel_funcs nt37290_drm_funcs = {
 
 static const struct exynos_panel_funcs nt37290_exynos_funcs = {
 	.set_brightness = nt37290_set_brightness,
+	.convert_brightness = nt37290_convert_brightness,
 	.set_lp_mode = nt37290_set_lp_mode,
 	.set_nolp_mode = nt37290_set_nolp_mode,
 	.set_binned_lp = exynos_panel_set_binned_lp,
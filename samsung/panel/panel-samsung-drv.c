@@ -266,15 +266,104 @@ static int exynos_panel_parse_regulators(struct exynos_panel *ctx)
 	return 0;
 }
 
-int exynos_panel_read_id(struct exynos_panel *ctx)
+static bool exynos_panel_reg_cache_get(struct exynos_panel *ctx, u8 reg, void *buf, size_t len)
+{
+	bool hit = false;
+	u32 i;
+
+	mutex_lock(&ctx->reg_cache_lock);
+	for (i = 0; i < ctx->num_reg_cache; i++) {
+		const struct exynos_panel_reg_cache *c = &ctx->reg_cache[i];
+
+		if (c->reg == reg && c->len == len) {
+			memcpy(buf, c->data, len);
+			hit = true;
+			break;
+		}
+	}
+	mutex_unlock(&ctx->reg_cache_lock);
+
+	return hit;
+}
+
+static void exynos_panel_reg_cache_put(struct exynos_panel *ctx, u8 reg,
+				       const void *buf, size_t len)
+{
+	struct exynos_panel_reg_cache *c;
+
+	if (len > PANEL_REG_CACHE_DATA_MAX)
+		return;
+
+	mutex_lock(&ctx->reg_cache_lock);
+	if (ctx->num_reg_cache < PANEL_REG_CACHE_SIZE) {
+		c = &ctx->reg_cache[ctx->num_reg_cache++];
+		c->reg = reg;
+		c->len = len;
+		memcpy(c->data, buf, len);
+	} else {
+		dev_dbg(ctx->dev, "register cache is full, 0x%02x not cached\n", reg);
+	}
+	mutex_unlock(&ctx->reg_cache_lock);
+}
+
+int exynos_panel_read_regs_cached(struct exynos_panel *ctx,
+				  struct exynos_dsi_read *reads, u32 num_reads)
 {
 	struct mipi_dsi_device *dsi = to_mipi_dsi_device(ctx->dev);
+	struct exynos_dsi_read misses[PANEL_REG_CACHE_SIZE];
+	u32 miss_idx[PANEL_REG_CACHE_SIZE];
+	u32 i, num_misses = 0;
+	ssize_t ret;
+
+	for (i = 0; i < num_reads; i++) {
+		struct exynos_dsi_read *r = &reads[i];
+
+		if (exynos_panel_reg_cache_get(ctx, r->reg, r->rx_buf, r->rx_len)) {
+			r->ret = r->rx_len;
+			continue;
+		}
+
+		if (num_misses == ARRAY_SIZE(misses))
+			return -E2BIG;
+		miss_idx[num_misses] = i;
+		misses[num_misses++] = *r;
+	}
+
+	if (!num_misses)
+		return 0;
+
+	ret = exynos_dsi_dcs_read_batch(dsi, misses, num_misses);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < num_misses; i++) {
+		const struct exynos_dsi_read *m = &misses[i];
+
+		reads[miss_idx[i]].ret = m->ret;
+		if (i >= (u32)ret)
+			return m->ret < 0 ? m->ret : -EIO;
+		if (m->ret != m->rx_len)
+			return m->ret < 0 ? m->ret : -EIO;
+
+		exynos_panel_reg_cache_put(ctx, m->reg, m->rx_buf, m->rx_len);
+	}
+
+	return 0;
+}
+EXPORT_SYMBOL(exynos_panel_read_regs_cached);
+
+int exynos_panel_read_id(struct exynos_panel *ctx)
+{
 	char buf[PANEL_ID_READ_SIZE];
+	struct exynos_dsi_read read = {
+		.reg = ctx->desc->panel_id_reg ? : PANEL_ID_REG,
+		.rx_buf = buf,
+		.rx_len = PANEL_ID_READ_SIZE,
+	};
 	int ret;
 
-	ret = mipi_dsi_dcs_read(dsi, ctx->desc->panel_id_reg ? : PANEL_ID_REG,
-				buf, PANEL_ID_READ_SIZE);
-	if (ret != PANEL_ID_READ_SIZE) {
+	ret = exynos_panel_read_regs_cached(ctx, &read, 1);
+	if (ret) {
 		dev_warn(ctx->dev, "Unable to read panel id (%d)\n", ret);
 		return ret;
 	}
@@ -288,15 +377,21 @@ EXPORT_SYMBOL(exynos_panel_read_id);
 
 int exynos_panel_read_ddic_id(struct exynos_panel *ctx)
 {
-	struct mipi_dsi_device *dsi = to_mipi_dsi_device(ctx->dev);
 	char buf[PANEL_SLSI_DDIC_ID_LEN] = {0};
-	int ret;
+	struct exynos_dsi_read read = {
+		.reg = PANEL_SLSI_DDIC_ID_REG,
+		.rx_buf = buf,
+		.rx_len = PANEL_SLSI_DDIC_ID_LEN,
+	};
+	int ret = 0;
 
-	EXYNOS_DCS_BUF_ADD_AND_FLUSH(ctx, 0xF0, 0x5A, 0x5A);
-	ret = mipi_dsi_dcs_read(dsi, PANEL_SLSI_DDIC_ID_REG,
-				buf, PANEL_SLSI_DDIC_ID_LEN);
-	EXYNOS_DCS_BUF_ADD_AND_FLUSH(ctx, 0xF0, 0xA5, 0xA5);
-	if (ret != PANEL_SLSI_DDIC_ID_LEN) {
+	/* skip level key unlock if it's already cached */
+	if (!exynos_panel_reg_cache_get(ctx, read.reg, buf, read.rx_len)) {
+		EXYNOS_DCS_BUF_ADD_AND_FLUSH(ctx, 0xF0, 0x5A, 0x5A);
+		ret = exynos_panel_read_regs_cached(ctx, &read, 1);
+		EXYNOS_DCS_BUF_ADD_AND_FLUSH(ctx, 0xF0, 0xA5, 0xA5);
+	}
+	if (ret) {
 		dev_warn(ctx->dev, "Unable to read DDIC id (%d)\n", ret);
 		return ret;
 	}
@@ -309,19 +404,21 @@ EXPORT_SYMBOL(exynos_panel_read_ddic_id);
 
 static int exynos_panel_read_extinfo(struct exynos_panel *ctx)
 {
-	struct mipi_dsi_device *dsi = to_mipi_dsi_device(ctx->dev);
 	char buf[EXT_INFO_SIZE];
+	struct exynos_dsi_read reads[EXT_INFO_SIZE];
 	int i, ret;
 
 	for (i = 0; i < EXT_INFO_SIZE; i++) {
-		ret = mipi_dsi_dcs_read(dsi, ext_info_regs[i], buf + i, 1);
-		if (ret != 1) {
-			dev_warn(ctx->dev,
-				 "Unable to read panel extinfo (0x%x: %d)\n",
-				 ext_info_regs[i], ret);
-			return ret;
-		}
+		reads[i].reg = ext_info_regs[i];
+		reads[i].rx_buf = buf + i;
+		reads[i].rx_len = 1;
+		reads[i].ret = 0;
+	}
 
+	ret = exynos_panel_read_regs_cached(ctx, reads, EXT_INFO_SIZE);
+	if (ret) {
+		dev_warn(ctx->dev, "Unable to read panel extinfo (%d)\n", ret);
+		return ret;
 	}
 	exynos_bin2hex(buf, i, ctx->panel_extinfo, sizeof(ctx->panel_extinfo));
 
@@ -398,6 +495,11 @@ int exynos_panel_init(struct exynos_panel *ctx)
 		ctx->panel_rev = PANEL_REV_LATEST;
 	}
 
+	exynos_panel_pack_desc_cmd_sets(ctx);
+
+	if (funcs && funcs->convert_brightness)
+		exynos_panel_update_bl_lut(ctx);
+
 	if (funcs && funcs->read_id)
 		ret = funcs->read_id(ctx);
 	else
@@ -724,9 +826,196 @@ int exynos_panel_prepare(struct drm_panel *panel)
 }
 EXPORT_SYMBOL(exynos_panel_prepare);
 
+static u8 exynos_dsi_dcs_write_type(size_t len)
+{
+	switch (len) {
+	case 0:
+		/* allow flag only messages to dsim */
+		return 0;
+	case 1:
+		return MIPI_DSI_DCS_SHORT_WRITE;
+	case 2:
+		return MIPI_DSI_DCS_SHORT_WRITE_PARAM;
+	default:
+		return MIPI_DSI_DCS_LONG_WRITE;
+	}
+}
+
+static struct exynos_dsi_packed_cmd_set *
+exynos_panel_pack_cmd_set(struct exynos_panel *ctx, const struct exynos_dsi_cmd_set *cmd_set)
+{
+	struct mipi_dsi_device *dsi = to_mipi_dsi_device(ctx->dev);
+	struct exynos_dsi_packed_cmd_set *pset;
+	const struct exynos_dsi_cmd *c;
+	u32 num_cmd = 0, num_words = 0, i;
+	u32 *words;
+
+	for (i = 0; i < cmd_set->num_cmd; i++) {
+		c = &cmd_set->cmds[i];
+		if (!(c->panel_rev & ctx->panel_rev))
+			continue;
+		num_cmd++;
+		if (mipi_dsi_packet_format_is_long(exynos_dsi_dcs_write_type(c->cmd_len)))
+			num_words += DIV_ROUND_UP(c->cmd_len, 4);
+	}
+
+	pset = kzalloc(struct_size(pset, cmds, num_cmd) + num_words * sizeof(u32), GFP_KERNEL);
+	if (!pset)
+		return NULL;
+
+	pset->cmd_set = cmd_set;
+	pset->panel_rev = ctx->panel_rev;
+	words = (u32 *)&pset->cmds[num_cmd];
+
+	for (i = 0; i < cmd_set->num_cmd; i++) {
+		struct exynos_dsi_packed_cmd *pc = &pset->cmds[pset->num_cmd];
+		struct mipi_dsi_packet packet;
+		struct mipi_dsi_msg msg = {
+			.channel = dsi->channel,
+		};
+		u32 j;
+
+		c = &cmd_set->cmds[i];
+		if (!(c->panel_rev & ctx->panel_rev))
+			continue;
+
+		msg.type = exynos_dsi_dcs_write_type(c->cmd_len);
+		msg.tx_buf = c->cmd;
+		msg.tx_len = c->cmd_len;
+
+		pc->cmd = c;
+		pc->type = msg.type;
+		if (c->cmd_len && !mipi_dsi_create_packet(&packet, &msg))
+			memcpy(pc->header, packet.header, sizeof(pc->header));
+
+		if (mipi_dsi_packet_format_is_long(msg.type)) {
+			pc->payload = words;
+			pc->num_words = DIV_ROUND_UP(c->cmd_len, 4);
+			for (j = 0; j < c->cmd_len; j++)
+				words[j / 4] |= (u32)c->cmd[j] << (8 * (j % 4));
+			words += pc->num_words;
+		}
+
+		pset->num_cmd++;
+	}
+
+	return pset;
+}
+
+/*
+ * Look up the packed version of @cmd_set for the current panel_rev, building it on first
+ * use. Entries are never released before remove, so the returned set stays valid even if
+ * panel_rev changes while it's being sent.
+ */
+static const struct exynos_dsi_packed_cmd_set *
+exynos_panel_get_packed_cmd_set(struct exynos_panel *ctx, const struct exynos_dsi_cmd_set *cmd_set)
+{
+	struct exynos_dsi_packed_cmd_set *pset;
+	const u32 panel_rev = ctx->panel_rev;
+
+	/* commands can't be filtered until panel revision is known */
+	if (!panel_rev)
+		return NULL;
+
+	mutex_lock(&ctx->packed_lock);
+	hash_for_each_possible(ctx->packed_cmd_sets, pset, node, (unsigned long)cmd_set) {
+		if (pset->cmd_set == cmd_set && pset->panel_rev == panel_rev)
+			goto out;
+	}
+
+	pset = exynos_panel_pack_cmd_set(ctx, cmd_set);
+	if (pset) {
+		hash_add(ctx->packed_cmd_sets, &pset->node, (unsigned long)cmd_set);
+		dev_dbg(ctx->dev, "packed cmd set %ps: %u/%u cmds for rev 0x%x\n",
+			cmd_set, pset->num_cmd, cmd_set->num_cmd, panel_rev);
+	}
+out:
+	mutex_unlock(&ctx->packed_lock);
+
+	return pset;
+}
+
+static void exynos_panel_pack_desc_cmd_sets(struct exynos_panel *ctx)
+{
+	const struct exynos_panel_desc *desc = ctx->desc;
+	int i;
+
+	if (desc->off_cmd_set)
+		exynos_panel_get_packed_cmd_set(ctx, desc->off_cmd_set);
+	if (desc->lp_cmd_set)
+		exynos_panel_get_packed_cmd_set(ctx, desc->lp_cmd_set);
+	for (i = 0; i < desc->num_binned_lp; i++)
+		exynos_panel_get_packed_cmd_set(ctx, &desc->binned_lp[i].cmd_set);
+}
+
+static void exynos_panel_free_packed_cmd_sets(struct exynos_panel *ctx)
+{
+	struct exynos_dsi_packed_cmd_set *pset;
+	struct hlist_node *tmp;
+	int bkt;
+
+	mutex_lock(&ctx->packed_lock);
+	hash_for_each_safe(ctx->packed_cmd_sets, bkt, tmp, pset, node) {
+		hash_del(&pset->node);
+		kfree(pset);
+	}
+	mutex_unlock(&ctx->packed_lock);
+}
+
+static ssize_t exynos_dsi_packed_transfer(struct mipi_dsi_device *dsi,
+					  const struct exynos_dsi_packed_cmd *pc, u16 flags)
+{
+	const struct mipi_dsi_host_ops *ops = dsi->host->ops;
+	struct exynos_dsi_packed_msg pmsg = {
+		.msg = {
+			.channel = dsi->channel,
+			.type = pc->type,
+			.tx_buf = pc->cmd->cmd,
+			.tx_len = pc->cmd->cmd_len,
+			.flags = flags,
+		},
+		.payload = pc->payload,
+		.num_words = pc->num_words,
+	};
+
+	if (!ops || !ops->transfer)
+		return -ENOSYS;
+
+	/* flag only messages carry no packet */
+	if (pc->cmd->cmd_len) {
+		memcpy(pmsg.header, pc->header, sizeof(pmsg.header));
+		pmsg.msg.flags |= EXYNOS_DSI_MSG_PACKED;
+	}
+	if (dsi->mode_flags & MIPI_DSI_MODE_LPM)
+		pmsg.msg.flags |= MIPI_DSI_MSG_USE_LPM;
+
+	return ops->transfer(dsi->host, &pmsg.msg);
+}
+
+static void exynos_panel_send_packed_cmd_set(struct exynos_panel *ctx,
+					     const struct exynos_dsi_packed_cmd_set *pset,
+					     u16 dsi_flags, u32 flags)
+{
+	struct mipi_dsi_device *dsi = to_mipi_dsi_device(ctx->dev);
+	u32 i;
+
+	for (i = 0; i < pset->num_cmd; i++) {
+		const struct exynos_dsi_packed_cmd *pc = &pset->cmds[i];
+		const u32 delay_ms = pc->cmd->delay_ms;
+
+		if ((i == pset->num_cmd - 1) && !(flags & PANEL_CMD_SET_QUEUE))
+			dsi_flags |= MIPI_DSI_MSG_LASTCOMMAND;
+
+		exynos_dsi_packed_transfer(dsi, pc, dsi_flags);
+		if (delay_ms)
+			usleep_range(delay_ms * 1000, delay_ms * 1000 + 10);
+	}
+}
+
 void exynos_panel_send_cmd_set_flags(struct exynos_panel *ctx,
 				     const struct exynos_dsi_cmd_set *cmd_set, u32 flags)
 {
+	const struct exynos_dsi_packed_cmd_set *pset;
 	struct mipi_dsi_device *dsi = to_mipi_dsi_device(ctx->dev);
 	const struct exynos_dsi_cmd *c;
 	const struct exynos_dsi_cmd *last_cmd = NULL;
@@ -746,6 +1035,12 @@ void exynos_panel_send_cmd_set_flags(struct exynos_panel *ctx,
 	if (!(flags & async_mask))
 		dsi_flags |= MIPI_DSI_MSG_LASTCOMMAND;
 
+	pset = exynos_panel_get_packed_cmd_set(ctx, cmd_set);
+	if (pset) {
+		exynos_panel_send_packed_cmd_set(ctx, pset, dsi_flags, flags);
+		return;
+	}
+
 	c = &cmd_set->cmds[cmd_set->num_cmd - 1];
 	if (!c->panel_rev) {
 		last_cmd = c;
@@ -856,6 +1151,107 @@ static int exynos_get_brightness(struct backlight_device *bl)
 	return bl->props.brightness;
 }
 
+static int exynos_panel_build_bl_lut_band(struct exynos_panel *ctx,
+					  struct exynos_bl_lut_band *band,
+					  u32 min_br, u32 max_br)
+{
+	const struct exynos_panel_funcs *funcs = ctx->desc->exynos_panel_func;
+	const u32 num_levels = max_br - min_br + 1;
+	u32 i;
+
+	if (min_br > max_br || max_br > U16_MAX || num_levels > PANEL_BL_LUT_MAX_LEVELS)
+		return -EINVAL;
+
+	/*
+	 * Conversions are piecewise and nonlinear, keep one exact entry per
+	 * level rather than interpolating between samples.
+	 */
+	band->dbv = kcalloc(num_levels, sizeof(*band->dbv), GFP_KERNEL);
+	if (!band->dbv)
+		return -ENOMEM;
+
+	band->min_br = min_br;
+	band->max_br = max_br;
+	for (i = 0; i < num_levels; i++)
+		band->dbv[i] = funcs->convert_brightness(ctx, min_br + i);
+
+	dev_dbg(ctx->dev, "bl lut band %u-%u\n", min_br, max_br);
+
+	return 0;
+}
+
+static void exynos_panel_free_bl_lut(struct exynos_bl_lut *lut)
+{
+	int i;
+
+	for (i = 0; i < PANEL_BL_LUT_BAND_MAX; i++) {
+		kfree(lut->bands[i].dbv);
+		lut->bands[i].dbv = NULL;
+	}
+}
+
+int exynos_panel_update_bl_lut(struct exynos_panel *ctx)
+{
+	const struct exynos_panel_funcs *funcs = ctx->desc->exynos_panel_func;
+	const struct brightness_capability *brt = ctx->desc->brt_capability;
+	struct exynos_bl_lut lut = { .panel_rev = ctx->panel_rev };
+	int ret;
+
+	if (!funcs || !funcs->convert_brightness || !brt)
+		return -EOPNOTSUPP;
+
+	ret = exynos_panel_build_bl_lut_band(ctx, &lut.bands[PANEL_BL_LUT_BAND_NORMAL],
+					     brt->normal.level.min,
+					     brt->normal.level.max);
+	if (!ret && brt->hbm.level.max)
+		ret = exynos_panel_build_bl_lut_band(ctx, &lut.bands[PANEL_BL_LUT_BAND_HBM],
+						     brt->hbm.level.min,
+						     brt->hbm.level.max);
+	if (ret) {
+		/* stale tables must not outlive the settings, convert directly instead */
+		dev_warn(ctx->dev, "failed to build bl lut (%d)\n", ret);
+		exynos_panel_free_bl_lut(&lut);
+	}
+
+	mutex_lock(&ctx->bl_lut_lock);
+	swap(ctx->bl_lut, lut);
+	mutex_unlock(&ctx->bl_lut_lock);
+
+	exynos_panel_free_bl_lut(&lut);
+
+	return ret;
+}
+EXPORT_SYMBOL(exynos_panel_update_bl_lut);
+
+u16 exynos_panel_get_dbv(struct exynos_panel *ctx, u16 br)
+{
+	const struct exynos_panel_funcs *funcs = ctx->desc->exynos_panel_func;
+	int i;
+
+	mutex_lock(&ctx->bl_lut_lock);
+	if (ctx->bl_lut.panel_rev == ctx->panel_rev) {
+		for (i = 0; i < PANEL_BL_LUT_BAND_MAX; i++) {
+			const struct exynos_bl_lut_band *band = &ctx->bl_lut.bands[i];
+			u16 dbv;
+
+			if (!band->dbv || br < band->min_br || br > band->max_br)
+				continue;
+
+			dbv = band->dbv[br - band->min_br];
+			mutex_unlock(&ctx->bl_lut_lock);
+
+			return dbv;
+		}
+	}
+	mutex_unlock(&ctx->bl_lut_lock);
+
+	if (funcs && funcs->convert_brightness)
+		return funcs->convert_brightness(ctx, br);
+
+	return br;
+}
+EXPORT_SYMBOL(exynos_panel_get_dbv);
+
 static int exynos_bl_find_range(struct exynos_panel *ctx,
 				int brightness, u32 *range)
 {
@@ -866,6 +1262,16 @@ static int exynos_bl_find_range(struct exynos_panel *ctx,
 
 	mutex_lock(&ctx->bl_state_lock);
 
+	/* consecutive updates of a brightness ramp mostly stay in current range */
+	i = ctx->bl_notifier.current_range;
+	if (i < ctx->bl_notifier.num_ranges && brightness <= ctx->bl_notifier.ranges[i] &&
+	    (!i || brightness > ctx->bl_notifier.ranges[i - 1])) {
+		*range = i;
+		mutex_unlock(&ctx->bl_state_lock);
+
+		return 0;
+	}
+
 	for (i = 0; i < ctx->bl_notifier.num_ranges; i++) {
 		if (brightness <= ctx->bl_notifier.ranges[i]) {
 			*range = i;
@@ -2121,30 +2527,67 @@ static ssize_t exynos_dsi_dcs_transfer(struct mipi_dsi_device *dsi, u8 type,
 ssize_t exynos_dsi_dcs_write_buffer(struct mipi_dsi_device *dsi,
 				  const void *data, size_t len, u16 flags)
 {
-	u8 type;
+	return exynos_dsi_dcs_transfer(dsi, exynos_dsi_dcs_write_type(len), data, len, flags);
+}
+EXPORT_SYMBOL(exynos_dsi_dcs_write_buffer);
 
-	switch (len) {
-	case 0:
-		/* allow flag only messages to dsim */
-		type = 0;
-		break;
+ssize_t exynos_dsi_dcs_read_batch(struct mipi_dsi_device *dsi,
+				  struct exynos_dsi_read *reads, u32 num_reads)
+{
+	const struct mipi_dsi_host_ops *ops = dsi->host->ops;
+	struct exynos_dsi_read_batch batch = {
+		.msg = {
+			.channel = dsi->channel,
+			.type = MIPI_DSI_DCS_READ,
+			.flags = EXYNOS_DSI_MSG_READ_BATCH,
+		},
+		.reads = reads,
+		.num_reads = num_reads,
+	};
 
-	case 1:
-		type = MIPI_DSI_DCS_SHORT_WRITE;
-		break;
+	if (!ops || !ops->transfer)
+		return -ENOSYS;
 
-	case 2:
-		type = MIPI_DSI_DCS_SHORT_WRITE_PARAM;
-		break;
+	if (!num_reads)
+		return 0;
 
-	default:
-		type = MIPI_DSI_DCS_LONG_WRITE;
-		break;
-	}
+	/* tx fields describe the first read for host logging */
+	batch.msg.tx_buf = &reads[0].reg;
+	batch.msg.tx_len = 1;
+	if (dsi->mode_flags & MIPI_DSI_MODE_LPM)
+		batch.msg.flags |= MIPI_DSI_MSG_USE_LPM;
 
-	return exynos_dsi_dcs_transfer(dsi, type, data, len, flags);
+	return ops->transfer(dsi->host, &batch.msg);
 }
-EXPORT_SYMBOL(exynos_dsi_dcs_write_buffer);
+EXPORT_SYMBOL(exynos_dsi_dcs_read_batch);
+
+ssize_t exynos_dsi_dcs_write_buffer_async(struct mipi_dsi_device *dsi,
+					  const void *data, size_t len, u16 flags,
+					  void (*complete)(void *data, int ret),
+					  void *complete_data)
+{
+	const struct mipi_dsi_host_ops *ops = dsi->host->ops;
+	struct exynos_dsi_async_msg amsg = {
+		.msg = {
+			.channel = dsi->channel,
+			.type = exynos_dsi_dcs_write_type(len),
+			.tx_buf = data,
+			.tx_len = len,
+			.flags = flags | EXYNOS_DSI_MSG_ASYNC,
+		},
+		.complete = complete,
+		.data = complete_data,
+	};
+
+	if (!ops || !ops->transfer)
+		return -ENOSYS;
+
+	if (dsi->mode_flags & MIPI_DSI_MODE_LPM)
+		amsg.msg.flags |= MIPI_DSI_MSG_USE_LPM;
+
+	return ops->transfer(dsi->host, &amsg.msg);
+}
+EXPORT_SYMBOL(exynos_dsi_dcs_write_buffer_async);
 
 static int exynos_dsi_name_show(struct seq_file *m, void *data)
 {
@@ -3894,6 +4337,10 @@ int exynos_panel_common_init(struct mipi_dsi_device *dsi,
 	mutex_init(&ctx->mode_lock);
 	mutex_init(&ctx->bl_state_lock);
 	mutex_init(&ctx->lp_state_lock);
+	mutex_init(&ctx->packed_lock);
+	mutex_init(&ctx->reg_cache_lock);
+	mutex_init(&ctx->bl_lut_lock);
+	hash_init(ctx->packed_cmd_sets);
 
 	drm_panel_init(&ctx->panel, dev, ctx->desc->panel_func, DRM_MODE_CONNECTOR_DSI);
 
@@ -3966,10 +4413,53 @@ int exynos_panel_remove(struct mipi_dsi_device *dsi)
 	sysfs_remove_file(&ctx->bl->dev.kobj, &dev_attr_cabc_mode.attr);
 	devm_backlight_device_unregister(ctx->dev, ctx->bl);
 
+	exynos_panel_free_packed_cmd_sets(ctx);
+	exynos_panel_free_bl_lut(&ctx->bl_lut);
+
 	return 0;
 }
 EXPORT_SYMBOL(exynos_panel_remove);
 
+void exynos_panel_model_init(struct mipi_dsi_device *dsi, struct exynos_panel *ctx,
+			     const struct exynos_panel_desc *desc)
+{
+	int i;
+
+	mipi_dsi_set_drvdata(dsi, ctx);
+	ctx->dev = &dsi->dev;
+	ctx->desc = desc;
+	ctx->current_mode = &desc->modes[0];
+	ctx->panel_state = PANEL_STATE_OFF;
+
+	for (i = 0; i < desc->num_modes; i++) {
+		const int vrefresh = drm_mode_vrefresh(&desc->modes[i].mode);
+
+		if (ctx->peak_vrefresh < vrefresh)
+			ctx->peak_vrefresh = vrefresh;
+	}
+
+	dsi->lanes = desc->data_lane_cnt;
+	dsi->format = MIPI_DSI_FMT_RGB888;
+
+	mutex_init(&ctx->mode_lock);
+	mutex_init(&ctx->bl_state_lock);
+	mutex_init(&ctx->lp_state_lock);
+	mutex_init(&ctx->packed_lock);
+	mutex_init(&ctx->reg_cache_lock);
+	mutex_init(&ctx->bl_lut_lock);
+	hash_init(ctx->packed_cmd_sets);
+
+	drm_panel_init(&ctx->panel, ctx->dev, desc->panel_func, DRM_MODE_CONNECTOR_DSI);
+}
+EXPORT_SYMBOL(exynos_panel_model_init);
+
+void exynos_panel_model_free(struct exynos_panel *ctx)
+{
+	exynos_panel_free_packed_cmd_sets(ctx);
+	exynos_panel_free_bl_lut(&ctx->bl_lut);
+}
+EXPORT_SYMBOL(exynos_panel_model_free);
+
 MODULE_AUTHOR("Jiun Yu <jiun.yu@samsung.com>");
 MODULE_DESCRIPTION("MIPI-DSI based Samsung common panel driver");
 MODULE_LICENSE("GPL");
@@ -19,6 +19,7 @@
 #include <linux/regulator/consumer.h>
 #include <linux/gpio/consumer.h>
 #include <linux/backlight.h>
+#include <linux/hashtable.h>
 #include <drm/drm_bridge.h>
 #include <drm/drm_connector.h>
 #include <drm/drm_crtc.h>
@@ -183,6 +184,15 @@ struct exynos_panel_funcs {
 	 */
 	int (*set_brightness)(struct exynos_panel *exynos_panel, u16 br);
 
+	/**
+	 * @convert_brightness:
+	 *
+	 * This callback is used to convert a brightness level to panel DBV. When
+	 * provided, panel core samples it into per band lookup tables after panel
+	 * revision is known and exynos_panel_get_dbv() serves conversions from them.
+	 */
+	u16 (*convert_brightness)(struct exynos_panel *exynos_panel, u16 br);
+
 	/**
 	 * @set_lp_mode:
 	 *
@@ -456,6 +466,86 @@ struct exynos_dsi_cmd_set {
 	const struct exynos_dsi_cmd *cmds;
 };
 
+/**
+ * struct exynos_dsi_packed_cmd - dsi command with its packet pre-built.
+ * @cmd:       Source command.
+ * @type:      DSI data type derived from the command length.
+ * @header:    Packet header bytes.
+ * @num_words: Number of 32-bit payload fifo words, 0 for short packets.
+ * @payload:   Payload packed in fifo word order.
+ */
+struct exynos_dsi_packed_cmd {
+	const struct exynos_dsi_cmd *cmd;
+	u8 type;
+	u8 header[3];
+	u32 num_words;
+	const u32 *payload;
+};
+
+/**
+ * struct exynos_dsi_packed_cmd_set - cmd set filtered for one panel revision.
+ * @node:      Entry in exynos_panel packed_cmd_sets hashtable.
+ * @cmd_set:   Source command set.
+ * @panel_rev: Panel revision used to filter the source commands.
+ * @num_cmd:   Number of commands left after filtering.
+ * @cmds:      Packed commands.
+ */
+struct exynos_dsi_packed_cmd_set {
+	struct hlist_node node;
+	const struct exynos_dsi_cmd_set *cmd_set;
+	u32 panel_rev;
+	u32 num_cmd;
+	struct exynos_dsi_packed_cmd cmds[];
+};
+
+#define PANEL_PACKED_CMD_SET_HASH_BITS	4
+
+#define PANEL_REG_CACHE_SIZE		8
+#define PANEL_REG_CACHE_DATA_MAX	16
+
+/**
+ * struct exynos_panel_reg_cache - read back value of an immutable panel register.
+ * @reg:  DCS register.
+ * @len:  Number of bytes in @data.
+ * @data: Register value.
+ */
+struct exynos_panel_reg_cache {
+	u8 reg;
+	u8 len;
+	u8 data[PANEL_REG_CACHE_DATA_MAX];
+};
+
+/* bounds memory of brightness lookup table, 8KB per band at most */
+#define PANEL_BL_LUT_MAX_LEVELS		4096
+
+enum exynos_bl_lut_band_type {
+	PANEL_BL_LUT_BAND_NORMAL,
+	PANEL_BL_LUT_BAND_HBM,
+	PANEL_BL_LUT_BAND_MAX,
+};
+
+/**
+ * struct exynos_bl_lut_band - brightness to DBV table of one brightness band.
+ * @min_br: First brightness level of the band.
+ * @max_br: Last brightness level of the band.
+ * @dbv:    DBV of every brightness level from @min_br to @max_br.
+ */
+struct exynos_bl_lut_band {
+	u16 min_br;
+	u16 max_br;
+	u16 *dbv;
+};
+
+/**
+ * struct exynos_bl_lut - brightness to DBV tables filled from @convert_brightness.
+ * @panel_rev: Panel revision the tables were built for.
+ * @bands:     Tables of normal and hbm band, a band without table has no @dbv.
+ */
+struct exynos_bl_lut {
+	u32 panel_rev;
+	struct exynos_bl_lut_band bands[PANEL_BL_LUT_BAND_MAX];
+};
+
 /**
  * struct exynos_binned_lp - information for binned lp mode.
  * @name:         Name of this binned lp mode.
@@ -612,6 +702,19 @@ struct exynos_panel {
 	u32 panel_rev;
 	enum drm_panel_orientation orientation;
 
+	/* cmd sets packed for panel_rev, built on first use and kept until remove */
+	struct mutex packed_lock;
+	DECLARE_HASHTABLE(packed_cmd_sets, PANEL_PACKED_CMD_SET_HASH_BITS);
+
+	/* immutable registers (ids, extinfo) read once and kept across power cycles */
+	struct mutex reg_cache_lock;
+	struct exynos_panel_reg_cache reg_cache[PANEL_REG_CACHE_SIZE];
+	u32 num_reg_cache;
+
+	/* brightness to DBV tables, rebuilt by exynos_panel_update_bl_lut() */
+	struct mutex bl_lut_lock;
+	struct exynos_bl_lut bl_lut;
+
 	struct device_node *touch_dev;
 
 	struct te2_data te2;
@@ -936,10 +1039,37 @@ int exynos_panel_common_init(struct mipi_dsi_device *dsi,
 				struct exynos_panel *ctx);
 ssize_t exynos_dsi_dcs_write_buffer(struct mipi_dsi_device *dsi,
 				const void *data, size_t len, u16 flags);
+/*
+ * Queue a dcs write on the dsi host and return without waiting for the transfer. @data is
+ * copied, @complete (optional) is called from host command thread with transfer result.
+ */
+ssize_t exynos_dsi_dcs_write_buffer_async(struct mipi_dsi_device *dsi,
+				const void *data, size_t len, u16 flags,
+				void (*complete)(void *data, int ret), void *complete_data);
+/* Read dcs registers back to back in one host transaction, returns number of reads done */
+ssize_t exynos_dsi_dcs_read_batch(struct mipi_dsi_device *dsi,
+				struct exynos_dsi_read *reads, u32 num_reads);
+/*
+ * Read immutable panel registers, serving them from the panel register cache when possible.
+ * Missing registers are read in one batch and cached on success.
+ */
+int exynos_panel_read_regs_cached(struct exynos_panel *ctx,
+				struct exynos_dsi_read *reads, u32 num_reads);
+/* (Re)build brightness lookup tables, call when brightness settings change */
+int exynos_panel_update_bl_lut(struct exynos_panel *ctx);
+/* Convert brightness to DBV through lookup tables, falls back to @convert_brightness */
+u16 exynos_panel_get_dbv(struct exynos_panel *ctx, u16 br);
 ssize_t exynos_dsi_cmd_send_flags(struct mipi_dsi_device *dsi, u16 flags);
 
 int exynos_panel_probe(struct mipi_dsi_device *dsi);
 int exynos_panel_remove(struct mipi_dsi_device *dsi);
+/*
+ * Set up panel context of @desc on @dsi without hw resources, backlight or drm objects,
+ * so that its command sequences can be replayed against the dsim link model
+ */
+void exynos_panel_model_init(struct mipi_dsi_device *dsi, struct exynos_panel *ctx,
+			     const struct exynos_panel_desc *desc);
+void exynos_panel_model_free(struct exynos_panel *ctx);
 
 static inline void exynos_dsi_dcs_write_buffer_force_batch_begin(struct mipi_dsi_device *dsi)
 {